@@ -0,0 +1,120 @@
+//************************************************************************//
+// Built-in benchmark for the Small Device C Compiler (SDCC)              //
+//                                                                        //
+// Prints a fixed test pattern on the Wheelwriter in phases (plain        //
+// strikes, bold, underline, tabs, carriage returns and line feeds) and   //
+// times each phase with the time base. The elapsed time, the number of   //
+// bus words sent and the mean and longest Printer Board acknowledge      //
+// wait of each phase are then printed on UART1, so that machines and     //
+// printwheels can be compared in the field.                              //
+//************************************************************************//
+
+#include <stdio.h>
+#include "reg51.h"
+#include "stc51.h"
+#include "control.h"
+#include "ww-uart4.h"
+#include "timebase.h"
+#include "wheelwriter.h"
+#include "bench.h"
+
+#define FALSE 0
+#define TRUE  1
+
+#define PHASES 6
+
+extern unsigned char column;            // current print column; defined in diablo.c
+extern unsigned char tabStop;           // horizontal tab spacing; defined in diablo.c
+extern unsigned char uSpacesPerChar;    // micro spaces per character; defined in wheelwriter.c
+extern __bit lineBuffering;             // line buffering and bidirectional printing; defined in wheelwriter.c
+
+__code char benchPattern[] = "The quick brown fox jumps over the lazy dog 0123456789";
+const char * __code benchPhase[PHASES] = {"strikes","bold","underline","tabs","CR","LF"};
+
+//-----------------------------------------------------------
+// prints one phase of the test pattern
+//-----------------------------------------------------------
+void bench_phase(unsigned char phase) {
+    unsigned char i;
+
+    switch(phase) {
+        case 0:                                     // plain strikes
+        case 1:                                     // bold
+        case 2:                                     // underline
+            for(i=0; benchPattern[i]; i++) {
+                ww_print_character(benchPattern[i],(phase == 0) ? 0 : (phase == 1) ? ATTR_BOLD : ATTR_UNDERLINE);
+                RESET_WDT;
+            }
+            break;
+        case 3:                                     // tabs, a character at each tab stop across the line
+            for(i=0; i<50/tabStop; i++) {
+                ww_horizontal_tab(tabStop);
+                ww_print_character('|',0);
+                RESET_WDT;
+            }
+            break;
+        case 4:                                     // carriage returns from near the right margin
+            for(i=0; i<5; i++) {
+                ww_horizontal_tab(60);
+                ww_print_character('<',0);
+                ww_carriage_return();
+                ww_flush();
+                while (printer_board_busy()) RESET_WDT;
+            }
+            ww_linefeed();
+            break;
+        case 5:                                     // line feeds
+            for(i=0; i<6; i++) {
+                ww_linefeed();
+                ww_flush();
+                while (printer_board_busy()) RESET_WDT;
+            }
+            break;
+    }
+    if (phase < 4) {
+        ww_carriage_return();
+        ww_linefeed();
+    }
+    ww_flush();
+    while (printer_board_busy()) RESET_WDT;         // the phase ends when the Printer Board has acknowledged everything
+}
+
+//-----------------------------------------------------------
+// prints the test pattern and the summary. the pattern is
+// printed without line buffering, one character at a time as
+// when typing, so the phases can be timed separately.
+//-----------------------------------------------------------
+void bench_run(void) {
+    unsigned char phase;
+    __bit buffering;
+    unsigned long start,elapsed,words,total,max;
+    unsigned long count;
+
+    ww_flush();
+    while (printer_board_busy()) RESET_WDT;
+    buffering = lineBuffering;
+    ww_line_buffering(FALSE);
+    if (column != 1) {                              // start from the left margin
+        ww_carriage_return();
+        ww_linefeed();
+    }
+
+    printf("\nBENCHMARK %u micro spaces/character\n",(int)uSpacesPerChar);
+    printf("phase      elapsed ms  words  acks  mean ack us  max ack us\n");
+    for(phase=0; phase<PHASES; phase++) {
+        ack_timing(TRUE);
+        start = timestamp();
+        bench_phase(phase);
+        elapsed = timestamp()-start;
+        ack_timing(FALSE);
+        words = words4;                             // the ISR has stopped timing, safe to read
+        count = ack4_count;
+        total = ack4_total;
+        max = ack4_max;
+        printf("%-10s %10lu %6lu %5lu %12lu %11lu\n",benchPhase[phase],elapsed/1000,words,count,count ? total/count : 0,max);
+    }
+    printf(".\n");
+
+    ww_line_buffering(buffering);
+    column = 1;
+}
@@ -0,0 +1,8 @@
+// for the Small Device C Compiler (SDCC)
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+void bench_run(void);
+
+#endif
@@ -1,28 +1,37 @@
-@ECHO OFF
-
-REM compile...
-sdcc -c main.c 
-sdcc -c wheelwriter.c
-sdcc -c uart1.c
-sdcc -c uart2.c
-sdcc -c ww-uart3.c
-sdcc -c ww-uart4.c
-
-REM link...
-sdcc main.c wheelwriter.rel uart1.rel uart2.rel ww-uart3.rel ww-uart4.rel
-
-REM generate HEX file...
-packihx main.ihx > teletype.hex
-
-REM optional cleanup...
-del *.asm
-del *.ihx
-del *.lk
-del *.lst
-del *.map
-del *.mem
-del *.rel
-del *.rst
-del *.sym
-
-pause
+@ECHO OFF
+
+REM compile...
+sdcc -c main.c 
+sdcc -c wheelwriter.c
+sdcc -c diablo.c
+sdcc -c uart1.c
+sdcc -c uart2.c
+sdcc -c ww-uart3.c
+sdcc -c ww-uart4.c
+sdcc -c eeprom.c
+sdcc -c trace.c
+sdcc -c bench.c
+sdcc -c timebase.c
+sdcc -c profile.c
+sdcc -c latency.c
+sdcc -c calibrate.c
+sdcc -c stress.c
+
+REM link, keeping xdata below the watchdog reset counters at 0xEF0...
+sdcc --xram-size 0x0EF0 main.c wheelwriter.rel diablo.rel uart1.rel uart2.rel ww-uart3.rel ww-uart4.rel eeprom.rel trace.rel bench.rel timebase.rel profile.rel latency.rel calibrate.rel stress.rel
+
+REM generate HEX file...
+packihx main.ihx > teletype.hex
+
+REM optional cleanup...
+del *.asm
+del *.ihx
+del *.lk
+del *.lst
+del *.map
+del *.mem
+del *.rel
+del *.rst
+del *.sym
+
+pause
@@ -0,0 +1,249 @@
+//************************************************************************//
+// Mechanical timing calibration for the Small Device C Compiler (SDCC)   //
+//                                                                        //
+// Wheelwriter mechanisms and printwheels differ in speed. Prints a line  //
+// of strikes with the printwheel turning different numbers of spokes     //
+// between them, moves the carrier and the paper different distances and  //
+// times each command from being queued until the Printer Board           //
+// acknowledges it. A straight line is fitted to the times for each kind  //
+// of movement and printed on UART1. The printwheel times and the         //
+// carrier's fixed time are converted into the micro spaces of carrier    //
+// travel used by the strike ordering cost model, which is updated and    //
+// saved in the EEPROM so that it's used from then on. The arithmetic is  //
+// done in sized types (stdint.h, through hal.h) so that the host test in //
+// ../tools, built with gcc, does it in the same widths as SDCC.          //
+//************************************************************************//
+
+#include <stdio.h>
+#include "hal.h"
+#include "reg51.h"
+#include "stc51.h"
+#include "control.h"
+#include "ww-uart4.h"
+#include "timebase.h"
+#include "eeprom.h"
+#include "wheelwriter.h"
+#include "calibrate.h"
+
+#define FALSE 0
+#define TRUE  1
+
+#define WHEELREPS   4                   // pairs of strikes timed at each printwheel distance
+#define CARRIERREPS 2                   // pairs of carrier movements timed at each distance
+#define PAPERREPS   2                   // pairs of paper movements timed at each distance
+
+#define HALFWHEEL   48                  // the printwheel turns the shorter way, never more than half its 96 spokes
+
+#define MOVEWORDS   235                 // us taken by the 4 bus words of a carrier move command at 187500bps
+#define FITUNIT     16                  // times are summed in units of 16 us, or fitN*fitXY overflows 32 bits
+
+extern unsigned char column;            // current print column; defined in diablo.c
+extern unsigned char uSpacesPerChar;    // micro spaces per character; defined in wheelwriter.c
+extern char __code ASCII2printwheel[96];// printwheel code of each printable character; defined in wheelwriter.c
+
+__code uint8_t calSpokes[] = {12,24,36,48};             // printwheel distances in spokes
+__code uint16_t calMicroSpaces[] = {12,60,240,600};     // carrier distances in micro spaces
+__code uint8_t calMicroLines[] = {2,8,16,31};           // paper distances in micro lines
+
+// sums for fitting a straight line, time = intercept + slope * distance. with times
+// in units of 16 us, fitN*fitXY stays below 2^31 for carrier moves of up to 600
+// micro spaces at up to about 1.2 ms per micro space.
+uint8_t __xdata fitN;
+uint16_t __xdata fitX;
+int32_t __xdata fitY,fitXY,fitXX;
+
+//-----------------------------------------------------------
+// empties the sums for a new straight line fit
+//-----------------------------------------------------------
+void cal_fit_start(void) {
+    fitN = fitX = fitY = fitXX = fitXY = 0;
+}
+
+//-----------------------------------------------------------
+// adds a point, 'usec' microseconds for a movement of
+// 'distance', to the fit
+//-----------------------------------------------------------
+void cal_fit_point(uint16_t distance,int32_t usec) {
+    usec = (usec+FITUNIT/2)/FITUNIT;
+    ++fitN;
+    fitX += distance;
+    fitY += usec;
+    fitXX += (int32_t)distance*distance;
+    fitXY += distance*usec;
+}
+
+//-----------------------------------------------------------
+// fits the least squares straight line through the points,
+// returns the intercept and slope in microseconds. the
+// slope is worked out in 1/16 us from the quotient and the
+// remainder, since the numerator can't be scaled up, so
+// that rounding it doesn't throw the intercept out. returns
+// FALSE if the distances don't allow a fit.
+//-----------------------------------------------------------
+uint8_t cal_fit(int32_t *intercept,int32_t *slope) {
+    int32_t d,n,fine;
+
+    d = fitN*fitXX-(int32_t)fitX*fitX;
+    if (!d) return FALSE;
+    n = fitN*fitXY-fitX*fitY;
+    fine = (n/d)*FITUNIT*16;                        // slope in 1/16 us
+    n %= d;
+    while (d >= 0x800000L) {                        // so that the remainder can be multiplied by 256
+        d >>= 1;
+        n /= 2;
+    }
+    fine += n*(FITUNIT*16)/d;
+    *slope = (fine+8)/16;
+    *intercept = (fitY*FITUNIT-fine*fitX/16)/fitN;
+    return TRUE;
+}
+
+//-----------------------------------------------------------
+// waits for the Printer Board to acknowledge everything
+// queued since 'start', returns the time taken
+//-----------------------------------------------------------
+int32_t cal_wait(uint32_t start) {
+    while (printer_board_busy()) RESET_WDT;
+    return (int32_t)(timestamp()-start);
+}
+
+//-----------------------------------------------------------
+// returns the printwheel code of the printable character
+// whose distance from printwheel code 'code' is closest to
+// 'spokes' spokes
+//-----------------------------------------------------------
+uint8_t cal_partner(uint8_t code,uint8_t spokes) {
+    uint8_t i,best,d,bestd;
+
+    best = code;
+    bestd = 0xFF;
+    for(i=0x21; i<0x7F; i++) {                      // every printable character except space
+        if (!ASCII2printwheel[i-0x20]) continue;    // not on the printwheel
+        d = ww_wheel_distance(code,ASCII2printwheel[i-0x20]);
+        d = (d > spokes) ? d-spokes : spokes-d;
+        if (d < bestd) {
+            best = ASCII2printwheel[i-0x20];
+            bestd = d;
+        }
+    }
+    return best;
+}
+
+//-----------------------------------------------------------
+// times strikes alternating between two characters 'spokes'
+// spokes apart on the printwheel, adds them to the fit and
+// returns the mean time
+//-----------------------------------------------------------
+int32_t cal_wheel(uint8_t code,uint8_t spokes) {
+    uint8_t i,partner;
+    uint32_t start;
+    int32_t t,total = 0;
+
+    partner = spokes ? cal_partner(code,spokes) : code;
+    spokes = ww_wheel_distance(code,partner);       // the nearest there is
+    ww_strike(code,uSpacesPerChar);                 // start from 'code'
+    cal_wait(timestamp());
+    for(i=0; i<WHEELREPS*2; i++) {
+        start = timestamp();
+        ww_strike((i & 0x01) ? code : partner,uSpacesPerChar);
+        t = cal_wait(start);
+        if (spokes) cal_fit_point(spokes,t);
+        total += t;
+    }
+    return total/(WHEELREPS*2);
+}
+
+//-----------------------------------------------------------
+// prints the calibration line, fits the timing model, then
+// updates the strike ordering cost model and saves it in the
+// EEPROM. the results are printed on UART1: the time taken
+// by each kind of movement as a fixed time plus a time per
+// spoke, micro space or micro line, then the cost model.
+//-----------------------------------------------------------
+void calibrate_run(void) {
+    uint8_t i,j,code,settle,perSpoke,carrierStart,carrierMove;
+    uint32_t start;
+    int32_t still,wheelFixed,wheelPerSpoke,fixed,slope;
+
+    ww_flush();
+    while (printer_board_busy()) RESET_WDT;
+    if (column != 1) {                              // start from the left margin
+        ww_carriage_return();
+        ww_linefeed();
+        ww_flush();
+        while (printer_board_busy()) RESET_WDT;
+    }
+    printf("\nCALIBRATION\n");
+
+    // the printwheel, on one line of strikes
+    code = ASCII2printwheel['e'-0x20];
+    still = cal_wheel(code,0);                      // strikes without turning the printwheel
+    cal_fit_start();
+    for(i=0; i<sizeof(calSpokes); i++)
+        cal_wheel(code,calSpokes[i]);
+    ww_carriage_return();
+    ww_linefeed();
+    ww_flush();
+    cal_wait(timestamp());
+    column = 1;
+    if (!cal_fit(&wheelFixed,&wheelPerSpoke)) {
+        printf("failed\n.\n");
+        return;
+    }
+    printf("printwheel: %6ld us + %5ld us/spoke, %ld us without turning\n",(long)wheelFixed,(long)wheelPerSpoke,(long)still);
+
+    // the carrier, out from the left margin and back
+    cal_fit_start();
+    for(i=0; i<sizeof(calMicroSpaces)/sizeof(calMicroSpaces[0]); i++) {
+        for(j=0; j<CARRIERREPS*2; j++) {
+            start = timestamp();
+            ww_move_carrier((j & 0x01) ? 0 : calMicroSpaces[i]);
+            cal_fit_point(calMicroSpaces[i],cal_wait(start));
+        }
+    }
+    if (!cal_fit(&fixed,&slope) || (slope <= 0)) {
+        printf("failed\n.\n");
+        return;
+    }
+    printf("carrier:    %6ld us + %5ld us/micro space\n",(long)fixed,(long)slope);
+
+    // the strike ordering cost model, in micro spaces of carrier travel
+    wheelPerSpoke = (wheelPerSpoke+slope/2)/slope;
+    if (wheelPerSpoke < 1) wheelPerSpoke = 1;
+    if (wheelPerSpoke > 255/HALFWHEEL) wheelPerSpoke = 255/HALFWHEEL;
+    perSpoke = wheelPerSpoke;
+    wheelFixed = (wheelFixed-still+slope/2)/slope;  // starting and stopping the printwheel
+    if (wheelFixed < 0) wheelFixed = 0;
+    if (wheelFixed > 255-perSpoke*HALFWHEEL) wheelFixed = 255-perSpoke*HALFWHEEL;
+    settle = wheelFixed;
+    fixed = (fixed-MOVEWORDS+slope/2)/slope;        // starting and stopping the carrier
+    if (fixed < 0) fixed = 0;
+    if (fixed > 254) fixed = 254;                   // 0xFF means not calibrated
+    carrierStart = fixed;
+    fixed = (MOVEWORDS+slope/2)/slope;              // sending the move command
+    if (fixed > 254) fixed = 254;
+    carrierMove = fixed;
+
+    // the paper, up and back down
+    cal_fit_start();
+    for(i=0; i<sizeof(calMicroLines); i++) {
+        for(j=0; j<PAPERREPS*2; j++) {
+            start = timestamp();
+            ww_vertical((j & 0x01) ? -(int)calMicroLines[i] : calMicroLines[i]);
+            ww_move_paper();
+            cal_fit_point(calMicroLines[i],cal_wait(start));
+        }
+    }
+    if (cal_fit(&fixed,&slope))
+        printf("paper:      %6ld us + %5ld us/micro line\n",(long)fixed,(long)slope);
+
+    ww_cost_model(settle,perSpoke,carrierStart,carrierMove);
+    save_setting(EE_WHEELSETTLE,settle);
+    save_setting(EE_WHEELPERSPOKE,perSpoke);
+    save_setting(EE_CARRIERSTART,carrierStart);
+    save_setting(EE_CARRIERMOVE,carrierMove);
+    printf("cost model: printwheel settle %u, %u per spoke, carrier start %u, move %u (micro spaces)\n.\n",(int)settle,(int)perSpoke,(int)carrierStart,(int)carrierMove);
+    ww_linefeed();
+    ww_flush();
+    while (printer_board_busy()) RESET_WDT;
+}
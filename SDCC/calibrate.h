@@ -0,0 +1,8 @@
+// for the Small Device C Compiler (SDCC)
+
+#ifndef __CALIBRATE_H__
+#define __CALIBRATE_H__
+
+void calibrate_run(void);
+
+#endif
@@ -0,0 +1,321 @@
+//************************************************************************//
+// Diablo 630 emulation: prints the characters received from the host and //
+// carries out the control characters and escape sequences.               //
+//                                                                        //
+// The only hardware touched here is through wheelwriter.c, uart2.c and   //
+// eeprom.c, so with hal.h this file also compiles with gcc on Linux for  //
+// the host benchmark in ../tools.                                        //
+//************************************************************************//
+
+#include <stdio.h>
+#include "hal.h"
+#include "uart2.h"
+#include "eeprom.h"
+#include "control.h"
+#include "wheelwriter.h"
+#include "diablo.h"
+
+#define FALSE 0
+#define TRUE  1
+
+__bit autoLineFeed = FALSE;             // when true, automatically print a linefeed with each carriage return received from the serial port
+__bit autoCarriageReturn = FALSE;       // when true, automatically print a carriage return with each linefeed received from the serial port (for Linux)
+
+unsigned char attribute = 0;            // ATTR_BOLD, ATTR_UNDERLINE and ATTR_WORDS (see wheelwriter.h)
+unsigned char draftMask = 0;            // draft mode, the attribute bits set here are ignored when printing
+unsigned char column = 1;               // current print column (1=left margin)
+unsigned char tabStop = 5;              // horizontal tabs every 5 spaces (every 1/2 inch)
+
+extern unsigned char uSpacesPerChar;    // micro spaces per character; defined in wheelwriter.c
+extern unsigned char uLinesPerLine;     // micro lines per line; defined in wheelwriter.c
+extern __bit strikeOrdering;            // printwheel-aware strike ordering; defined in wheelwriter.c
+extern unsigned long __xdata hostBaudRate; // UART2 baud rate, 9600 or 115200; defined in main.c
+extern unsigned char __xdata idleFlush; // host silence before a partial line is printed; defined in main.c
+
+//------------------------------------------------------------------------------------------
+// The Wheelwriter prints the character and updates the variable 'column'.
+// Carriage return cancels bold and underlining and resets 'column' back to 1.
+// Linefeeds automatically printed with carriage return if flag 'autoLineFeed' is TRUE.
+// The character printed by the Wheelwriter is echoed to the serial port (for monitoring).
+//
+// Control characters:
+//   BEL 0x07    spins the printwheel
+//   BS  0x08    non-destructive backspace
+//   TAB 0x09    horizontal tab to next tab stop
+//   LF  0x0A    moves paper up one line
+//   VT  0x0B    moves paper up one line
+//   FF  0x0C    moves paper up to the next top of form
+//   CR  0x0D    returns carriage to left margin. if autoLineFeed is on, paper moves up one line (linefeed)
+//   ESC 0x1B    see Diablo 630 commands below...
+//
+// Diablo 630 commands emulated:
+//   <ESC><O>    selects bold printing
+//   <ESC><&>    cancels bold printing
+//   <ESC><E>    selects continuous underlining  (spaces between words are underlined) for one line
+//   <ESC><R>    cancels underlining
+//   <ESC><X>    cancels both bold and underlining
+//   <ESC><U>    half line feed (paper up 1/2 line)
+//   <ESC><D>    reverse half line feed (paper down 1/2 line)
+//   <ESC><BS>   backspace 1/120 inch
+//   <ESC><LF>   reverse line feed (paper down one line)
+//   <ESC></>    enables bidirectional printing (lines are buffered, every other line printed right to left)
+//   <ESC><\>    disables bidirectional printing
+//   <ESC><FF><n> sets page length to n lines (n is a binary value 1-127)
+//   <ESC><T>    sets top of form at the current line
+//
+// printer control not part of the Diablo 630 emulation:
+//   <ESC><u>    selects micro paper up (1/8 line or 1/48")
+//   <ESC><d>    selects micro paper down (1/8 line or 1/48")
+//   <ESC><b>    selects broken underlining (spaces between words are not underlined)
+//   <ESC><l><n> auto linefeed (n=1 is on, n=0 is off)
+//   <ESC><c><n> auto carriage return (n=1 is on, n=0 is off)
+//   <ESC><o><n> strike ordering (n=1 is on, n=0 is off). when bidirectional printing is enabled,
+//               each line is printed in the order that minimizes printwheel and carrier travel
+//   <ESC><q><n> draft mode. bit 0 of n prints bold with a single strike, bit 1 (or bit 2) drops both
+//               continuous and broken underlining. n=3 does both, n=0 is letter quality. the bold and
+//               underline settings themselves are kept, so they're printed again after <ESC><q><0>
+//   <ESC><s><n> host baud rate (n=1 is 115200bps, n=0 is 9600bps). ACK is sent at the old rate, then
+//               the rate changes. the host must send nothing more until it receives the ACK, then
+//               switch its own rate. RTS is held high from the ACK until 100ms after the change, so a
+//               host that also waits for RTS to go low sees it high first.
+//   <ESC><S><n> saves the power-on host baud rate in EEPROM (n=1 is 115200bps, n=0 is 9600bps), replies ACK.
+//               the EEPROM erase stops all interrupts for about 21ms, so RTS pauses the host and the
+//               Printer Board finishes what it's doing first. keys pressed during the erase may be lost.
+//   <ESC><W><p><r> sets the UART2 spool watermarks and saves them in EEPROM, replies ACK. p and r are binary
+//               values in units of 16 bytes: RTS pauses the host when less than p*16 bytes of the spool are
+//               free and resumes it when more than r*16 bytes are. p must be at least 1 and less than r, and
+//               r*16 less than the spool size, or the watermarks are left as they were (and NAK is replied).
+//   <ESC><I><n> sets how long the host must stop sending before a partial line in the line buffer is printed
+//               and saves it in EEPROM, replies ACK. n is a binary value 0-254 in units of 50ms (the default
+//               is 10, 1/2 second), n=0 never prints it early. with bidirectional printing and nothing left
+//               in the line buffer, only the paper is moved: the carrier stays where the last line ended.
+//   <ESC><p>    selects Pica pitch (10 characters/inch or 12 point)
+//   <ESC><e>    selects Elite pitch (12 characters/inch or 10 point)
+//   <ESC><m>    selects Micro Elite pitch (15 characters/inch or 8 point)
+//-------------------------------------------------------------------------------------------
+void print_char_on_WW(unsigned char charToPrint) {
+    static unsigned char escape = 0;                        // escape sequence state
+    static unsigned char pauseLevel;                        // first value of <ESC><W><p><r>
+    unsigned char i,t;
+
+    switch(escape) {
+        case 0:                                             // first character
+            switch(charToPrint) {
+                case NUL:
+                    break;
+                case BEL:
+                    ww_spin();
+                    putchar(BEL);
+                    break;
+                case BS:
+                    if (column > 1){                        // only if there's at least one character on the line
+                        ww_backspace();
+                        --column;                           // update column
+                        //putchar(BS);
+                    }
+                    break;
+                case HT:
+                    t = tabStop-(column%tabStop);           // how many spaces to the next tab stop
+                    ww_horizontal_tab(t);                   // move carrier to the next tab stop
+                    for(i=0; i<t; i++){
+                        ++column;                           // update column
+                        putchar(SP);
+                    }
+                    break;
+                case LF:
+                    if (autoCarriageReturn)                 // if TRUE, automatically print carriage return
+                        ww_carriage_return();
+                    ww_linefeed();
+                    putchar(LF);
+                    break;
+                case VT:
+                    ww_linefeed();
+                    putchar(LF);
+                    break;
+                case FF:
+                    ww_form_feed();                         // paper up to the next top of form
+                    putchar(LF);
+                    break;
+                case CR:
+                    ww_carriage_return();                   // return the carrier to the left margin
+                    column = 1;                             // back to the left margin
+                    attribute = 0;                          // cancel bold and underlining
+                    if (autoLineFeed)                       // if TRUE, automatically print linefeed
+                        ww_linefeed();
+                    putchar(CR);
+                    break;
+                case ESC:
+                    escape = 1;                             // ESCAPE character detected, next state
+                    break;
+                default:
+                    if ((charToPrint>0x1F)&&(charToPrint<0x80)) { // 'printable' characters 0x20-0x7F
+                        ww_print_character(charToPrint,attribute & ~draftMask);
+                        putchar(charToPrint);               // echo the character to the console
+                        ++column;                           // update column
+                    }
+            } // switch(charToPrint)
+            break;  // case 0:
+        case 1:
+            escape = 0;                                     // <ESC> has been detected, this is the second character of the escape sequence...
+            switch(charToPrint) {
+                case 'O':                                   // <ESC><O> selects bold printing
+                    attribute |= ATTR_BOLD;
+                    break;
+                case '&':                                   // <ESC><&> cancels bold printing
+                    attribute &= ATTR_UNDERLINES;
+                    break;
+                case 'E':                                   // <ESC><E> selects continuous underline (spaces between words are underlined)
+                    attribute |= ATTR_UNDERLINE;
+                    break;
+                case 'R':                                   // <ESC><R> cancels underlining
+                    attribute &= ATTR_BOLD;
+                    break;
+                case 'X':                                   // <ESC><X> cancels both bold and underlining
+                    attribute = 0;
+                    break;
+                case 'U':                                   // <ESC><U> selects half line feed (paper up one half line)
+                    ww_paper_up();
+                    break;
+                case 'D':                                   // <ESC><D> selects reverse half line feed (paper down one half line)
+                    ww_paper_down();
+                    break;
+                case LF:                                    // <ESC><LF> selects reverse line feed (paper down one line)
+                    ww_reverse_linefeed();
+                    break;
+                case '/':                                   // <ESC></> enables bidirectional printing
+                    ww_line_buffering(TRUE);
+                    break;
+                case '\\':                                  // <ESC><\> disables bidirectional printing
+                    ww_line_buffering(FALSE);
+                    break;
+                case FF:
+                    escape = 4;                             // <ESC><FF> sets page length, the next character is the number of lines
+                    break;
+                case 'T':                                   // <ESC><T> sets top of form at the current line
+                    ww_top_of_form();
+                    break;
+                case BS:                                    // <ESC><BS> backspace 1/120 inch
+                    ww_micro_backspace();
+                    break;
+                case 'b':                                   // <ESC><b> selects broken underline (spaces between words are not underlined)
+                    attribute |= ATTR_WORDS;
+                    break;
+                case 'c':
+                    escape = 3;                             // <ESC><c> selects auto carriage return, the next character turns it on or off
+                    break;
+                case 'e':                                   // <ESC><e> selects Elite (12 characters/inch)
+                    uSpacesPerChar = 10;                    // 10 micro spaces/character
+                    uLinesPerLine = 16;                     // 16 micro lines/full line
+                    tabStop = 6;                            // tab stops every 6 characters (every 1/2 inch)
+                    break;
+                case 'l':                                   // <ESC><l> selects auto linefeed, the next character turns it on or off
+                    escape = 2;
+                    break;
+                case 'o':                                   // <ESC><o> selects strike ordering, the next character turns it on or off
+                    escape = 5;
+                    break;
+                case 'q':                                   // <ESC><q> selects draft mode, the next character is the attribute bits to ignore
+                    escape = 6;
+                    break;
+                case 's':                                   // <ESC><s> changes the host baud rate, the next character selects the rate
+                    escape = 7;
+                    break;
+                case 'S':                                   // <ESC><S> saves the power-on host baud rate, the next character selects the rate
+                    escape = 8;
+                    break;
+                case 'W':                                   // <ESC><W> sets the spool watermarks, the next two characters are the levels
+                    escape = 9;
+                    break;
+                case 'I':                                   // <ESC><I> sets the host idle time, the next character is the time
+                    escape = 11;
+                    break;
+                case 'p':                                   // <ESC><p> selects Pica (10 characters/inch)
+                    uSpacesPerChar = 12;                    // 10 micro spaces/character
+                    uLinesPerLine = 16;                     // 16 micro lines/full line
+                    tabStop = 5;                            // tab stops every 5 characters (every 1/2 inch)
+                    break;
+                case 'm':                                   // <ESC><m> selects Micro Elite (15 characters/inch)
+                    uSpacesPerChar = 8;                     // 10 micro spaces/character
+                    uLinesPerLine = 12;                     // 16 micro lines/full line
+                    tabStop = 7;                            // tab stops every 7 characters (every 1/2 inch)
+                    break;
+                case 'u':                                   // <ESC><u> paper micro up (paper up 1/8 line)
+                    ww_micro_up();
+                    break;
+                case 'd':                                   // <ESC><d> paper micro down (paper down 1/8 line)
+                    ww_micro_down();
+                    break;
+            } // switch(charToPrint)
+            break;  // case 1:
+        case 2:                                             // <ESC><l><n> has been detected. this is the third character of the escape sequence
+            escape = 0;
+            if (charToPrint & 0x01)
+                autoLineFeed = TRUE;                        // <ESC><l><n> odd values of n turn autoLineFeed on, even values turn autoLineFeed off
+            else
+                autoLineFeed = FALSE;
+            break; // case 2
+        case 3:                                             // <ESC><c><n> has been detected. this is the third character of the escape sequence
+            escape = 0;
+            if (charToPrint & 0x01)
+                autoCarriageReturn = TRUE;                  // <ESC><c><n> odd values of n turn autoCarriageReturn on, even values turn autoCarriageReturn off
+            else
+                autoCarriageReturn = FALSE;
+            break; // case 3
+        case 4:                                             // <ESC><FF><n> has been detected. this is the third character of the escape sequence
+            escape = 0;
+            ww_page_length(charToPrint);                    // n lines per page
+            break; // case 4
+        case 5:                                             // <ESC><o><n> has been detected. this is the third character of the escape sequence
+            escape = 0;
+            ww_print_line();                                // print anything buffered in the old order
+            if (charToPrint & 0x01)
+                strikeOrdering = TRUE;                      // <ESC><o><n> odd values of n turn strikeOrdering on, even values turn strikeOrdering off
+            else
+                strikeOrdering = FALSE;
+            break; // case 5
+        case 6:                                             // <ESC><q><n> has been detected. this is the third character of the escape sequence
+            escape = 0;
+            draftMask = 0;                                  // '0'-'3' work too
+            if (charToPrint & 0x01)
+                draftMask |= ATTR_BOLD;                     // bit 0 of n: bold with a single strike
+            if (charToPrint & 0x06)
+                draftMask |= ATTR_UNDERLINES;               // bit 1 or 2 of n: no underlining of either kind
+            break; // case 6
+        case 7:                                             // <ESC><s><n> has been detected. this is the third character of the escape sequence
+            escape = 0;
+            ww_flush();                                     // finish printing before the host is paused
+            hostBaudRate = (charToPrint & 0x01) ? 115200 : 9600;// <ESC><s><n> odd values of n select 115200bps, even values select 9600bps
+            putchar2(ACK);                                  // acknowledge at the old rate...
+            uart2_baudrate(hostBaudRate);                   // then change to the new rate
+            break; // case 7
+        case 8:                                             // <ESC><S><n> has been detected. this is the third character of the escape sequence
+            escape = 0;
+            save_setting(EE_HOSTBAUD,charToPrint & 0x01);   // <ESC><S><n> odd values of n select 115200bps at power-on, even values select 9600bps
+            putchar2(ACK);
+            break; // case 8
+        case 9:                                             // <ESC><W><p> has been detected. this is the third character of the escape sequence
+            escape = 10;
+            pauseLevel = charToPrint;
+            break; // case 9
+        case 10:                                            // <ESC><W><p><r> has been detected. this is the fourth character of the escape sequence
+            escape = 0;
+            if (uart2_watermarks(pauseLevel,charToPrint)) {
+                save_setting(EE_SPOOLPAUSE,pauseLevel);     // used from power-on as well
+                save_setting(EE_SPOOLRESUME,charToPrint);
+                putchar2(ACK);
+            }
+            else
+                putchar2(NAK);
+            break; // case 10
+        case 11:                                            // <ESC><I><n> has been detected. this is the third character of the escape sequence
+            escape = 0;
+            if (charToPrint != 0xFF) {                      // 0xFF is an erased EEPROM
+                idleFlush = charToPrint;
+                save_setting(EE_IDLEFLUSH,charToPrint);     // used from power-on as well
+                putchar2(ACK);
+            }
+            else
+                putchar2(NAK);
+            break; // case 11
+    } // switch(escape)
+}
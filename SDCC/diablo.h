@@ -0,0 +1,8 @@
+// for the Small Device C Compiler (SDCC)
+
+#ifndef __DIABLO_H__
+#define __DIABLO_H__
+
+void print_char_on_WW(unsigned char charToPrint);
+
+#endif
@@ -0,0 +1,110 @@
+//************************************************************************//
+// EEPROM functions for saving settings in the MCU's flash memory         //
+// for the Small Device C Compiler (SDCC)                                 //
+//                                                                        //
+// The IAP15W4K61S4 has no separate data EEPROM, instead the application  //
+// can use the IAP registers to read, program and erase the 512 byte      //
+// sectors of its own flash memory. The settings are kept in the last     //
+// sector, well above the end of the program. Erased flash reads 0xFF.    //
+//************************************************************************//
+
+#include "reg51.h"
+#include "stc51.h"
+#include "eeprom.h"
+#include "uart2.h"
+#include "ww-uart4.h"
+
+#define FALSE 0
+#define TRUE  1
+
+#define IAP_ENABLE      0x83            // IAPEN=1, wait time for a 12MHz system clock
+#define IAP_READ        0x01
+#define IAP_PROGRAM     0x02
+#define IAP_ERASE       0x03
+#define SETTINGSSECTOR  0xF200          // last 512 byte sector of the 61K flash memory
+
+//-----------------------------------------------------------
+// triggers the IAP command. the two trigger bytes must be
+// written back to back so interrupts are disabled. the CPU
+// stops until the command is finished.
+//-----------------------------------------------------------
+void iap_trigger(unsigned int address) {
+    unsigned char ea;
+
+    IAP_CONTR = IAP_ENABLE;
+    IAP_ADDRH = address>>8;
+    IAP_ADDRL = address;
+    ea = EA;
+    EA = 0;
+    IAP_TRIG = 0x5A;
+    IAP_TRIG = 0xA5;
+    EA = ea;
+    IAP_CONTR = 0;                      // disable IAP
+    IAP_CMD = 0;
+    IAP_TRIG = 0;
+    IAP_ADDRH = 0xFF;                   // point outside the flash memory
+    IAP_ADDRL = 0xFF;
+}
+
+//-----------------------------------------------------------
+// returns the byte at 'address'
+//-----------------------------------------------------------
+unsigned char eeprom_read(unsigned int address) {
+    IAP_CMD = IAP_READ;
+    iap_trigger(address);
+    return IAP_DATA;
+}
+
+//-----------------------------------------------------------
+// programs the byte at 'address'. programming can only clear
+// bits, the sector must have been erased first.
+//-----------------------------------------------------------
+void eeprom_write(unsigned int address,unsigned char value) {
+    IAP_CMD = IAP_PROGRAM;
+    IAP_DATA = value;
+    iap_trigger(address);
+}
+
+//-----------------------------------------------------------
+// erases the 512 byte sector containing 'address' (about 21
+// milliseconds during which interrupts are not serviced)
+//-----------------------------------------------------------
+void eeprom_erase(unsigned int address) {
+    IAP_CMD = IAP_ERASE;
+    iap_trigger(address);
+}
+
+//-----------------------------------------------------------
+// returns the setting saved at 'offset' in the settings block
+//-----------------------------------------------------------
+unsigned char get_setting(unsigned char offset) {
+    return eeprom_read(SETTINGSSECTOR+offset);
+}
+
+//-----------------------------------------------------------
+// saves 'value' at 'offset' in the settings block. the rest
+// of the settings block is read, the sector is erased and the
+// whole block is programmed back. nothing is written if the
+// setting already has that value. no interrupts are serviced
+// during the erase, so the host is paused with RTS and the
+// Printer Board is left to finish first: a character from the
+// host or a reply from the Printer Board arriving then would
+// overrun its UART. words from the Function Board (keys pressed
+// during the erase) can still be lost.
+//-----------------------------------------------------------
+void save_setting(unsigned char offset,unsigned char value) {
+    unsigned char __xdata settings[EE_SETTINGS];
+    unsigned char i;
+
+    if ((offset >= EE_SETTINGS) || (get_setting(offset) == value)) return;
+    for(i=0; i<EE_SETTINGS; i++)
+        settings[i] = get_setting(i);
+    settings[offset] = value;
+    uart2_hold(TRUE);                   // pause the host
+    while (printer_board_busy()) RESET_WDT;
+    eeprom_erase(SETTINGSSECTOR);
+    for(i=0; i<EE_SETTINGS; i++)
+        if (settings[i] != 0xFF)        // erased bytes are already 0xFF
+            eeprom_write(SETTINGSSECTOR+i,settings[i]);
+    uart2_hold(FALSE);
+}
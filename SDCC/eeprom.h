@@ -0,0 +1,23 @@
+// for the Small Device C Compiler (SDCC)
+
+#ifndef __EEPROM_H__
+#define __EEPROM_H__
+
+// offsets of the settings saved in the EEPROM settings block
+#define EE_HOSTBAUD      0              // host baud rate at power-on: 1=115200bps, anything else=9600bps
+#define EE_WHEELSETTLE   1              // strike ordering cost of starting and stopping the printwheel, 0xFF=not calibrated
+#define EE_WHEELPERSPOKE 2              // strike ordering cost of turning the printwheel one spoke, 0xFF=not calibrated
+#define EE_SPOOLPAUSE    3              // UART2 spool space, in 16 byte units, below which RTS pauses the host, 0xFF=default
+#define EE_SPOOLRESUME   4              // UART2 spool space, in 16 byte units, above which RTS resumes the host, 0xFF=default
+#define EE_CARRIERSTART  5              // strike ordering cost of starting and stopping the carrier, 0xFF=not calibrated
+#define EE_CARRIERMOVE   6              // strike ordering cost of sending a carrier move command, 0xFF=not calibrated
+#define EE_IDLEFLUSH     7              // 50 millisecond ticks of host silence before a partial line is printed, 0=never, 0xFF=default
+#define EE_SETTINGS      16             // size of the settings block
+
+unsigned char eeprom_read(unsigned int address);
+void eeprom_write(unsigned int address,unsigned char value);
+void eeprom_erase(unsigned int address);
+unsigned char get_setting(unsigned char offset);
+void save_setting(unsigned char offset,unsigned char value);
+
+#endif
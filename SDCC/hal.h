@@ -0,0 +1,42 @@
+// for the Small Device C Compiler (SDCC)
+//
+// Thin hardware abstraction for the sources that are also compiled with gcc on Linux
+// (wheelwriter.c and diablo.c for the host benchmark and calibrate.c for its test, in
+// ../tools). With either compiler it includes stdint.h: int is 16 bits with SDCC and 32
+// with gcc, long 32 and 64, so code whose arithmetic must overflow the same way on both
+// uses int32_t and the like, and widens 16 bit operands itself where they could overflow.
+// Otherwise, with SDCC this file does nothing. With any other compiler the 8051 storage
+// classes and keywords are defined away, the special function registers and bits become
+// ordinary variables and putchar() goes to hal_putchar() so the host build can record
+// what would have been echoed to UART1. The UART, EEPROM and host functions called by these sources are
+// provided by the host backend (../tools/hal_host.c) instead of uart2.c, ww-uart3.c,
+// ww-uart4.c, eeprom.c and timebase.c.
+
+#ifndef __HAL_H__
+#define __HAL_H__
+
+#include <stdint.h>
+
+#ifndef __SDCC
+
+#include <stdio.h>
+
+#define __xdata
+#define __data
+#define __idata
+#define __code
+#define __at(x)
+#define __interrupt(x)
+#define __using(x)
+#define __critical
+#define __bit           unsigned char
+#define __sfr           static volatile unsigned char
+#define __sbit          static volatile unsigned char
+
+#undef putchar
+#define putchar(c)      hal_putchar(c)
+int hal_putchar(int c);
+
+#endif
+
+#endif
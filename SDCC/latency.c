@@ -0,0 +1,172 @@
+//************************************************************************//
+// Host to strike latency for the Small Device C Compiler (SDCC)          //
+//                                                                        //
+// Times bytes from the host from the moment the UART2 ISR puts them in   //
+// the spool until the Printer Board acknowledges their last strike, so   //
+// that the effect of the spool, line buffering and strike ordering on    //
+// the response to a teletype user can be measured. The strikes of the    //
+// byte being timed are marked as they're made and the marks travel with  //
+// them through the line buffer and the Printer Board command queue, so a //
+// line printed right to left or in strike order ends the timing when the //
+// byte's own strikes are acknowledged, not when a given number of        //
+// strikes have been. One byte is timed at a time: when it has been       //
+// struck, or turns out to strike nothing, the next byte received is      //
+// timed. The bytes received in the meantime aren't timed, so the         //
+// latencies are a sample, and the report says how many of the bytes      //
+// received were timed. The latencies are kept in a histogram in internal //
+// MOVX SRAM and reported over UART1 as percentiles.                      //
+//************************************************************************//
+
+#include <stdio.h>
+#include "reg51.h"
+#include "stc51.h"
+#include "wheelwriter.h"
+#include "latency.h"
+
+volatile unsigned char latencyState = LATENCY_IDLE;
+unsigned int __xdata latencyIndex;          // spool index following the byte being timed
+unsigned long __xdata latencyStart;         // when it was received from the host
+unsigned long __xdata latencyEnd;           // when its strike was acknowledged
+unsigned char __xdata latencyTarget;        // strikes it made
+volatile unsigned char __xdata strikesDone; // strikes of it acknowledged by the Printer Board
+unsigned int __xdata latency_hist[LATENCYBINS];// number of bytes timed in each bin
+unsigned long __xdata latencyMax;           // longest latency in milliseconds
+unsigned long __xdata latencyReceived;      // bytes received from the host when the histogram was emptied
+__bit latencyThis;                          // set while the byte being timed is printed
+
+extern volatile unsigned int rx2_tail;      // defined in uart2.c
+extern volatile unsigned long __xdata rx2_total;// defined in uart2.c
+
+//-----------------------------------------------------------
+// called after a byte has been taken from the spool and
+// before it's printed. if it's the byte being timed, the
+// strikes it makes are marked.
+//-----------------------------------------------------------
+void latency_begin(void) {
+    latencyThis = (latencyState == LATENCY_SPOOLED) && (rx2_tail == latencyIndex);
+    if (latencyThis) {
+        CLR_ES4;                                    // no marked strikes are waiting, but be sure
+        strikesDone = 0;
+        SET_ES4;
+        ww_time_strikes(1);
+    }
+}
+
+//-----------------------------------------------------------
+// called after the byte has been printed. if it's the byte
+// being timed and it made strikes, waits for all of them to
+// be acknowledged, in whatever order the line is printed.
+// if it made none (a space, a control character or part of
+// an escape sequence), the next byte received is timed
+// instead.
+//-----------------------------------------------------------
+void latency_end(void) {
+    unsigned char target;
+
+    if (!latencyThis) return;
+    latencyThis = 0;
+    ww_time_strikes(0);
+    target = ww_strikes_timed();
+    if (!target) {
+        latencyState = LATENCY_IDLE;
+        return;
+    }
+    CLR_ES4;                                        // the UART4 ISR counts the marked strikes acknowledged
+    latencyTarget = target;
+    latencyState = LATENCY_PRINTING;
+    if (strikesDone >= target) {                    // already acknowledged
+        latencyEnd = timestamp();
+        latencyState = LATENCY_DONE;
+    }
+    SET_ES4;
+}
+
+//-----------------------------------------------------------
+// returns the histogram bin for a latency of 'ms'
+// milliseconds. bin 0 is less than 4 ms, then each doubling
+// is split into two bins: 4-5, 6-7, 8-11, 12-15, 16-23...
+//-----------------------------------------------------------
+unsigned char latency_bin(unsigned long ms) {
+    unsigned char bit = 2;
+
+    if (ms < 4) return 0;
+    while ((bit < 15) && (ms >= (2UL<<bit))) ++bit;// bit is the highest bit set in ms
+    if (bit == 15) return LATENCYBINS-1;
+    return ((bit-2)<<1)+1+((ms>>(bit-1)) & 0x01);
+}
+
+//-----------------------------------------------------------
+// returns the upper limit in milliseconds of histogram bin 'bin'
+//-----------------------------------------------------------
+unsigned long latency_limit(unsigned char bin) {
+    unsigned char bit;
+
+    if (!bin) return 4;
+    bit = ((bin-1)>>1)+2;
+    return (1UL<<bit)+((unsigned long)(((bin-1) & 0x01)+1)<<(bit-1));
+}
+
+//-----------------------------------------------------------
+// called from the main loop. adds the latency of the byte
+// being timed to the histogram once it has been struck.
+//-----------------------------------------------------------
+void latency_poll(void) {
+    unsigned long ms;
+    unsigned char bin;
+
+    if (latencyState != LATENCY_DONE) return;
+    ms = (latencyEnd-latencyStart)/1000;
+    bin = latency_bin(ms);
+    if (latency_hist[bin] != 0xFFFF) ++latency_hist[bin];
+    if (ms > latencyMax) latencyMax = ms;
+    latencyState = LATENCY_IDLE;                    // time the next byte received
+}
+
+//-----------------------------------------------------------
+// returns the upper limit in milliseconds of the bin that
+// holds the 'percent' percentile of the 'count' latencies,
+// the longest latency if it's in the last bin
+//-----------------------------------------------------------
+unsigned long latency_percentile(unsigned long count,unsigned char percent) {
+    unsigned char bin;
+    unsigned long n = 0;
+
+    for(bin=0; bin<LATENCYBINS-1; bin++) {
+        n += latency_hist[bin];
+        if (n*100 >= count*percent) break;
+    }
+    return (bin == LATENCYBINS-1) ? latencyMax : latency_limit(bin);
+}
+
+//-----------------------------------------------------------
+// prints the number of bytes timed out of those received
+// and the 50th and 99th percentile and longest latency in
+// milliseconds over UART1, then empties the histogram. the
+// percentiles are given as the upper limits of the bins they
+// fall in, so they're accurate to within about 40%. the
+// longest is exact. only one byte is timed at a time, so the
+// bytes received while one is being timed aren't counted:
+// the figures are a sample, weighted towards the bytes that
+// arrive after a pause.
+//-----------------------------------------------------------
+void latency_report(void) {
+    unsigned char bin;
+    unsigned long count = 0,received;
+
+    for(bin=0; bin<LATENCYBINS; bin++)
+        count += latency_hist[bin];
+    CLR_ES2;                                        // rx2_total is counted by the UART2 ISR
+    received = rx2_total-latencyReceived;
+    latencyReceived = rx2_total;
+    SET_ES2;
+    printf("\nLATENCY %lu of %lu bytes timed, one at a time\n",count,received);
+    if (count) {
+        printf("p50: <%lu ms\n",latency_percentile(count,50));
+        printf("p99: <%lu ms\n",latency_percentile(count,99));
+        printf("max:  %lu ms\n",latencyMax);
+    }
+    printf(".\n");
+    for(bin=0; bin<LATENCYBINS; bin++)
+        latency_hist[bin] = 0;
+    latencyMax = 0;
+}
@@ -0,0 +1,52 @@
+// for the Small Device C Compiler (SDCC)
+
+#ifndef __LATENCY_H__
+#define __LATENCY_H__
+
+#include "timebase.h"
+
+#define LATENCYBINS 28                  // bin 0: less than 4 ms, two bins per doubling to 32.8 s, bin 27: longer
+
+// what the byte being timed is doing
+#define LATENCY_IDLE     0              // no byte being timed, the next byte from the host will be
+#define LATENCY_SPOOLED  1              // waiting in the UART2 spool
+#define LATENCY_PRINTING 2              // waiting for its strike to be acknowledged
+#define LATENCY_DONE     3              // struck, waiting for latency_poll() to record it
+
+extern volatile unsigned char latencyState;
+extern unsigned int __xdata latencyIndex;       // spool index following the byte being timed
+extern unsigned long __xdata latencyStart;      // when it was received from the host
+extern unsigned long __xdata latencyEnd;        // when its strike was acknowledged
+extern unsigned char __xdata latencyTarget;     // strikes it made
+extern volatile unsigned char __xdata strikesDone;// strikes of it acknowledged by the Printer Board
+
+// ---------------------------------------------------------------------------
+// starts timing the byte just put in the spool if no other byte is being
+// timed. 'index' is the spool index following it, which is the tail index
+// once the byte has been taken out. used by the UART2 ISR.
+// ---------------------------------------------------------------------------
+#define LATENCY_RECEIVED(index)                                                \
+    if (latencyState == LATENCY_IDLE) {                                        \
+        latencyIndex = (index);                                                \
+        TIMESTAMP(latencyStart);                                               \
+        latencyState = LATENCY_SPOOLED;                                        \
+    }
+
+// ---------------------------------------------------------------------------
+// counts a strike of the byte being timed, acknowledged by the Printer Board
+// at time 'now', and stops timing the byte if it was the last of its strikes.
+// used by the UART4 ISR for the strikes marked PB_TIMED.
+// ---------------------------------------------------------------------------
+#define LATENCY_STRUCK(now)                                                    \
+    ++strikesDone;                                                             \
+    if ((latencyState == LATENCY_PRINTING) && (strikesDone == latencyTarget)) {\
+        latencyEnd = (now);                                                    \
+        latencyState = LATENCY_DONE;                                           \
+    }
+
+void latency_begin(void);
+void latency_end(void);
+void latency_poll(void);
+void latency_report(void);
+
+#endif
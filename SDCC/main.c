@@ -1,709 +1,758 @@
-//------------------------------------------------------------------------------------------
-// Uses an STCmicro IAP15W4K32S4 series micro controller to turn an IBM Wheelwriter Electronic
-// Typewriter into a teletype-like device.
-//
-// For the Small Device C Compiler (SDCC)
-//
-// UART1 used for debugging, monitor and in-application-programming - 115200bps N-8-1
-// UART2 used for communications with host PC - 9600bps N-8-1
-// UART3 used for communications with Wheelwriter Function Board
-// UART4 used for communications with Wheelwriter Printer Board
-//
-// Version 1.0.0 - Initial version
-// Version 1.1.0 - Changes necessary to make compatible with Wheelwriter 3, 5 and 6
-// Version 1.1.1 - Renamed some functions and variables for added readability
-// Version 1.2.0 - Watch Dog Timer added
-// Version 1.3.0 - reworked main() and ww_decode_key() functions
-// Version 1.3.1 - removed wheelwriter model detection code
-// Version 1.3.2 - revised line/local mode, diagnostics display
-// Version 1.3.3 - revised wheelwriter.c for ASCII Printwheel (part no. 1353909)
-// Version 1.3.4 - use UART1 for debugging and monitor
-// Version 1.3.5 - SDCC version
-//
-// NOTE: When using STCmicro's stc-isp application to download object code to the MCU,
-//       make sure the internal clock frequency is set to 12 MHz.
-//
-//------------------------------------------------------------------------------------------
-
-//-------------------------------------------------------------------------------------------------------------------------------------
-// Copyright 2019-2025 Jim Loos
-//
-// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
-// (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
-// publish, distribute, sub-license, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do
-// so, subject to the following conditions:
-//
-// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
-//
-// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
-// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
-// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
-// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
-//-------------------------------------------------------------------------------------------------------------------------------------
-
-#include <compiler.h>
-#include <stdio.h>
-#include <ctype.h>
-#include <stdlib.h>
-#include "reg51.h"
-#include "stc51.h"
-#include "control.h"
-#include "uart1.h"
-#include "uart2.h"
-#include "ww-uart3.h"
-#include "ww-uart4.h"
-#include "wheelwriter.h"
-
-#define FALSE 0
-#define TRUE  1
-#define LOW 0
-#define HIGH 1
-#define ON 0                            // 0 turns the LEDs on
-#define OFF 1                           // 1 turns the LEDs off
-
-// 12,000,000 Hz/12 = 1,000,000 Hz = 1.0 microsecond clock period
-// 50 milliseconds per interval/1.0 microseconds per clock = 50,000 clocks per interval
-#define RELOADHI (65536-50000)/256
-#define RELOADLO (65536-50000)&255
-#define ONESEC 20                       // 20*50 milliseconds = 1 second
-
-__sbit __at (0x85) redLED;              // red   LED connected to pin 6 0=on, 1=off
-__sbit __at (0x86) amberLED;            // amber LED connected to pin 7 0=on, 1=off
-__sbit __at (0x87) greenLED;            // green LED connected to pin 8 0=on, 1=off
-
-__bit autoLineFeed = FALSE;             // when true, automatically print a linefeed with each carriage return received from the serial port
-__bit autoCarriageReturn = FALSE;       // when true, automatically print a carriage return with each linefeed received from the serial port (for Linux)
-__bit errorLED = FALSE;                 // makes the red LED flash when TRUE
-__bit initializing = TRUE;              // makes all three LEDs flash during initialization
-__bit monitor = FALSE;                  // monitor communications between function and printer boards
-__bit localMode = TRUE;                 // when true wheelwriter keystrokes go to wheelwriter, when false wheelwriter keystrokes go to serial console
-
-unsigned char attribute = 0;            // bit 0=bold, bit 1=continuous underline, bit 2=multiple word underline
-unsigned char column = 1;               // current print column (1=left margin)
-unsigned char tabStop = 5;              // horizontal tabs every 5 spaces (every 1/2 inch)
-unsigned char printWheel = 0;           // 10pt, 12pt, 15pt or PS
-
-extern unsigned char uSpacesPerChar;    // micro spaces per character; defined in wheelwriter.c
-extern unsigned char uLinesPerLine;     // micro lines per line; defined in wheelwriter.c
-extern unsigned int  uSpaceCount;       // number of micro spaces on the current line; defined in wheelwriter.c
-
-volatile unsigned char timeout = 0;     // decremented every 50 milliseconds, used for detecting timeouts
-volatile unsigned char hours = 0;       // uptime hours
-volatile unsigned char minutes = 0;     // uptime minutes
-volatile unsigned char seconds = 0;     // uptime seconds
-
-// uninitialized variables in xdata RAM, contents unaffected by reset
-volatile __xdata __at (0xEF0) unsigned char wdResets;
-volatile __xdata __at (0xEF1) unsigned char softResetFlag;
-
-__code char about[] = "Wheelwriter Teletype Version 1.3.5\n"
-                      "for STCmicro IAP15W4K61S4 MCU and SDCC Compiler\n"
-                      "Compiled on " __DATE__ " at " __TIME__"\n"
-                      "Copyright 2019-2025 Jim Loos\n";
-
-__code char help1[] = "\n\nControl characters:\n"
-                      "  BEL 0x07        spins the printwheel\n"
-                      "  BS  0x08        non-destructive backspace\n"
-                      "  TAB 0x09        horizontal tab\n"
-                      "  LF  0x0A        paper up one line\n"
-                      "  VT  0x0B        paper up one line\n"
-                      "  CR  0x0D        returns carriage to left margin\n"
-                      "  ESC 0x1B        see Diablo 630 commands below...\n"
-                      "\nDiablo 630 commands emulated:\n"
-                      "  <ESC><O>        selects bold printing\n"
-                      "  <ESC><&>        cancels bold printing\n"
-                      "  <ESC><E>        selects continuous underlining\n"
-                      "  <ESC><R>        cancels underlining\n"
-                      "  <ESC><X>        cancels both bold and underlining\n"
-                      "  <ESC><U>        half line feed\n"
-                      "  <ESC><D>        reverse half line feed\n"
-                      "  <ESC><BS>       backspace 1/120 inch\n"
-                      "  <ESC><LF>       reverse line feed\n"
-                      "<Space> for more, <ESC> to exit...";
-__code char help2[] = "\n\nPrinter control not part of the Diablo 630 emulation:\n"
-                      "  <ESC><u>        selects micro paper up\n"
-                      "  <ESC><d>        selects micro paper down\n"
-                      "  <ESC><b>        selects broken underlining\n"
-                      "  <ESC><l><n>     auto linefeed on or off\n"
-                      "  <ESC><c><n>     auto carriage return on or off\n"
-                      "  <ESC><p>        selects Pica pitch\n"
-                      "  <ESC><e>        selects Elite pitch\n"
-                      "  <ESC><m>        selects Micro Elite pitch\n"
-                      "\nDiagnostics/debugging:\n"
-                      "  <ESC><^Z><a>    show version information\n"
-                      "  <ESC><^Z><l><n> turn flashing red error LED on or off\n"
-                      "  <ESC><^Z><m>    monitor Function Board commands\n"
-                      "  <ESC><^Z><p><n> show value of Port n (0-5)\n"
-                      "  <ESC><^Z><r>    reset the Wheelwriter\n"
-                      "  <ESC><^Z><u>    show uptime\n"
-                      "  <ESC><^Z><v>    show variables\n"
-                      "  <ESC><^Z><w>    show number of watchdog resets\n"
-                      "\nCode+Erase on Wheelwriter toggles line/local mode\n\n";
-
-//---------------------------------------------------------------------------------
-// Note that the two function below, _getkey() and putchar(), replace the library
-// functions of the same name.  These functions use the interrupt-driven serial
-// I/O routines in uart1.c
-//---------------------------------------------------------------------------------
-// for scanf
-char _getkey(void) {
-    return getchar1();              // return character from uart1
-}
-
-// for printf
-int putchar(int c)  {
-   return putchar1(c);              // send character to uart1
-}
-
-//------------------------------------------------------------
-// Timer 0 ISR: interrupt every 50 milliseconds, 20 times per second
-//------------------------------------------------------------
-void timer0_isr(void) __interrupt(1) __using(1) {
-    static unsigned char ticks = 0;
-
-    if (timeout) {                  // countdown value for detecting timeouts
-        --timeout;
-    }
-
-    if (initializing) {             // flash all three LEDs at 2Hz while initializing
-       amberLED = greenLED = redLED = (ticks < 10);
-    }
-
-    if (errorLED) {                 // flash red LED at 2Hz if error
-        redLED = (ticks < 10);
-    }
-
-    if(++ticks == 20) {             // if 20 ticks (one second) have elapsed...
-        ticks = 0;
-
-        if (++seconds == 60) {      // if 60 seconds (one minute) has elapsed...
-            seconds = 0;
-            if (++minutes == 60) {  // if 60 minutes (one hour) has elapsed...
-                minutes = 0;
-                ++hours;
-            }
-        }
-    }
-}
-
-//------------------------------------------------------------------------------------------
-// The Wheelwriter prints the character and updates the variable 'column'.
-// Carriage return cancels bold and underlining and resets 'column' back to 1.
-// Linefeeds automatically printed with carriage return if flag 'autoLineFeed' is TRUE.
-// The character printed by the Wheelwriter is echoed to the serial port (for monitoring).
-//
-// Control characters:
-//   BEL 0x07    spins the printwheel
-//   BS  0x08    non-destructive backspace
-//   TAB 0x09    horizontal tab to next tab stop
-//   LF  0x0A    moves paper up one line
-//   VT  0x0B    moves paper up one line
-//   CR  0x0D    returns carriage to left margin. if autoLineFeed is on, paper moves up one line (linefeed)
-//   ESC 0x1B    see Diablo 630 commands below...
-//
-// Diablo 630 commands emulated:
-//   <ESC><O>    selects bold printing
-//   <ESC><&>    cancels bold printing
-//   <ESC><E>    selects continuous underlining  (spaces between words are underlined) for one line
-//   <ESC><R>    cancels underlining
-//   <ESC><X>    cancels both bold and underlining
-//   <ESC><U>    half line feed (paper up 1/2 line)
-//   <ESC><D>    reverse half line feed (paper down 1/2 line)
-//   <ESC><BS>   backspace 1/120 inch
-//   <ESC><LF>   reverse line feed (paper down one line)
-//
-// printer control not part of the Diablo 630 emulation:
-//   <ESC><u>    selects micro paper up (1/8 line or 1/48")
-//   <ESC><d>    selects micro paper down (1/8 line or 1/48")
-//   <ESC><b>    selects broken underlining (spaces between words are not underlined)
-//   <ESC><l><n> auto linefeed (n=1 is on, n=0 is off)
-//   <ESC><c><n> auto carriage return (n=1 is on, n=0 is off)
-//   <ESC><p>    selects Pica pitch (10 characters/inch or 12 point)
-//   <ESC><e>    selects Elite pitch (12 characters/inch or 10 point)
-//   <ESC><m>    selects Micro Elite pitch (15 characters/inch or 8 point)
-//-------------------------------------------------------------------------------------------
-void print_char_on_WW(unsigned char charToPrint) {
-    static unsigned char escape = 0;                        // escape sequence state
-    unsigned char i,t;
-
-    switch(escape) {
-        case 0:                                             // first character
-            switch(charToPrint) {
-                case NUL:
-                    break;
-                case BEL:
-                    ww_spin();
-                    putchar(BEL);
-                    break;
-                case BS:
-                    if (column > 1){                        // only if there's at least one character on the line
-                        ww_backspace();
-                        --column;                           // update column
-                        //putchar(BS);
-                    }
-                    break;
-                case HT:
-                    t = tabStop-(column%tabStop);           // how many spaces to the next tab stop
-                    ww_horizontal_tab(t);                   // move carrier to the next tab stop
-                    for(i=0; i<t; i++){
-                        ++column;                           // update column
-                        putchar(SP);
-                    }
-                    break;
-                case LF:
-                    if (autoCarriageReturn)                 // if TRUE, automatically print carriage return
-                        ww_carriage_return();
-                    ww_linefeed();
-                    putchar(LF);
-                    break;
-                case VT:
-                    ww_linefeed();
-                    putchar(LF);
-                    break;
-                case CR:
-                    ww_carriage_return();                   // return the carrier to the left margin
-                    column = 1;                             // back to the left margin
-                    attribute = 0;                          // cancel bold and underlining
-                    if (autoLineFeed)                       // if TRUE, automatically print linefeed
-                        ww_linefeed();
-                    putchar(CR);
-                    break;
-                case ESC:
-                    escape = 1;                             // ESCAPE character detected, next state
-                    break;
-                default:
-                    if ((charToPrint>0x1F)&&(charToPrint<0x80)) { // 'printable' characters 0x20-0x7F
-                        ww_print_character(charToPrint,attribute);
-                        putchar(charToPrint);               // echo the character to the console
-                        ++column;                           // update column
-                    }
-            } // switch(charToPrint)
-            break;  // case 0:
-        case 1:
-            escape = 0;                                     // <ESC> has been detected, this is the second character of the escape sequence...
-            switch(charToPrint) {
-                case 'O':                                   // <ESC><O> selects bold printing
-                    attribute |= 0x01;
-                    break;
-                case '&':                                   // <ESC><&> cancels bold printing
-                    attribute &= 0x06;
-                    break;
-                case 'E':                                   // <ESC><E> selects continuous underline (spaces between words are underlined)
-                    attribute |= 0x02;
-                    break;
-                case 'R':                                   // <ESC><R> cancels underlining
-                    attribute &= 0x01;
-                    break;
-                case 'X':                                   // <ESC><X> cancels both bold and underlining
-                    attribute = 0;
-                    break;
-                case 'U':                                   // <ESC><U> selects half line feed (paper up one half line)
-                    ww_paper_up();
-                    break;
-                case 'D':                                   // <ESC><D> selects reverse half line feed (paper down one half line)
-                    ww_paper_down();
-                    break;
-                case LF:                                    // <ESC><LF> selects reverse line feed (paper down one line)
-                    ww_reverse_linefeed();
-                    break;
-                case BS:                                    // <ESC><BS> backspace 1/120 inch
-                    ww_micro_backspace();
-                    break;
-                case 'b':                                   // <ESC><b> selects broken underline (spaces between words are not underlined)
-                    attribute |= 0x04;
-                    break;
-                case 'c':
-                    escape = 3;                             // <ESC><c> selects auto carriage return, the next character turns it on or off
-                    break;
-                case 'e':                                   // <ESC><e> selects Elite (12 characters/inch)
-                    uSpacesPerChar = 10;                    // 10 micro spaces/character
-                    uLinesPerLine = 16;                     // 16 micro lines/full line
-                    tabStop = 6;                            // tab stops every 6 characters (every 1/2 inch)
-                    break;
-                case 'l':                                   // <ESC><l> selects auto linefeed, the next character turns it on or off
-                    escape = 2;
-                    break;
-                case 'p':                                   // <ESC><p> selects Pica (10 characters/inch)
-                    uSpacesPerChar = 12;                    // 10 micro spaces/character
-                    uLinesPerLine = 16;                     // 16 micro lines/full line
-                    tabStop = 5;                            // tab stops every 5 characters (every 1/2 inch)
-                    break;
-                case 'm':                                   // <ESC><m> selects Micro Elite (15 characters/inch)
-                    uSpacesPerChar = 8;                     // 10 micro spaces/character
-                    uLinesPerLine = 12;                     // 16 micro lines/full line
-                    tabStop = 7;                            // tab stops every 7 characters (every 1/2 inch)
-                    break;
-                case 'u':                                   // <ESC><u> paper micro up (paper up 1/8 line)
-                    ww_micro_up();
-                    break;
-                case 'd':                                   // <ESC><d> paper micro down (paper down 1/8 line)
-                    ww_micro_down();
-                    break;
-            } // switch(charToPrint)
-            break;  // case 1:
-        case 2:                                             // <ESC><l><n> has been detected. this is the third character of the escape sequence
-            escape = 0;
-            if (charToPrint & 0x01)
-                autoLineFeed = TRUE;                        // <ESC><l><n> odd values of n turn autoLineFeed on, even values turn autoLineFeed off
-            else
-                autoLineFeed = FALSE;
-            break; // case 2
-        case 3:                                             // <ESC><c><n> has been detected. this is the third character of the escape sequence
-            escape = 0;
-            if (charToPrint & 0x01)
-                autoCarriageReturn = TRUE;                  // <ESC><c><n> odd values of n turn autoCarriageReturn on, even values turn autoCarriageReturn off
-            else
-                autoCarriageReturn = FALSE;
-            break; // case 3
-    } // switch(escape)
-}
-
-#define PATTERN " %c%c%c%c%c%c%c%c\n"
-#define TO_BINARY(byte)  \
-  (byte & 0x80 ? '1' : '0'), \
-  (byte & 0x40 ? '1' : '0'), \
-  (byte & 0x20 ? '1' : '0'), \
-  (byte & 0x10 ? '1' : '0'), \
-  (byte & 0x08 ? '1' : '0'), \
-  (byte & 0x04 ? '1' : '0'), \
-  (byte & 0x02 ? '1' : '0'), \
-  (byte & 0x01 ? '1' : '0')
-
-//------------------------------------------------------------------------------------------
-// Process keystrokes from the UART1 monitor/debug serial connection
-//
-// for diagnostics/debugging:
-//   <ESC><h>        display help
-//   <ESC><^Z><a>    show version information
-//   <ESC><^Z><l><n> turn flashing red error LED on or off (n=1 is on, n=0 is off)
-//   <ESC><^Z><m>    monitor Function Board commands
-//   <ESC><^Z><p><n> show the value of Port n (0-5) as 2 digit hex number
-//   <ESC><^Z><r>    reset both the MCU and the wheelwriter
-//   <ESC><^Z><u>    show uptime as HH:MM:SS
-//   <ESC><^Z><v>    show variables
-//   <ESC><^Z><w>    show number of watchdog resets
-//-------------------------------------------------------------------------------------------
-void process_key(unsigned char key) {
-    static unsigned char escape = 0;                        // escape sequence state
-    unsigned char c;
-
-    switch(escape) {
-        case 0:                                             // first character
-            switch(key) {
-                case ESC:
-                    escape = 1;                             // ESCAPE character detected, next state
-                    break;
-            } // switch(key)
-            break;  // case 0:
-        case 1:
-            escape = 0;                                     // <ESC> has been detected, this is the second character of the escape sequence...
-            switch(key) {
-                case '\x1A':                                // <ESC><^Z> for remote diagnostics
-                    escape = 2;
-                    break;
-                case 'H':
-                case 'h':
-                    printf(help1);                          // print the first half of the help
-                    escape = 5;                             // wait for a key to be pressed...
-                    break;
-            } // switch(key)
-            break;  // case 1:
-        case 2:                                             // <ESC><^Z> detected, this is the third character of the escape sequence...
-            escape = 0;
-            switch(key) {
-               case 'A':
-               case 'a':                                    // <ESC><^Z><a> print version info
-                  printf("\n%s\n",about);
-                  for(c=1; c<column; c++) putchar(SP);      // return cursor to previous position on line
-                  break;
-               case 'L':
-               case 'l':                                    // <ESC><^Z><l> controls the red error LED. the next character turn is on or off
-                  escape = 4;
-                  break;
-               case 'M':
-               case 'm':                                    // <ESC><^Z><m> monitor communications
-                   monitor = !monitor;                      // toggle monitor flag
-                  break;
-               case 'P':
-               case 'p':                                    // <ESC><^Z><p> print port values. the next character selects the port number
-                  escape = 3;
-                  break;
-               case 'R':
-               case 'r':                                    // <ESC><^Z><r> reset the MCU and the Wheelwriter
-                  ww_reset(3);                              // reset both Wheelwriter boards
-                  softResetFlag = 0x55;                     // set the flag
-                  IAP_CONTR = 0x20;                         // reset the MCU
-                  break;
-               case 'U':
-               case 'u':                                    // <ESC><^Z><u> print uptime
-                  printf("\n%s %02u%c%02u%c%02u\n","Uptime:",(int)hours,':',(int)minutes,':',(int)seconds);
-                  for(c=1; c<column; c++) putchar(SP);      // return cursor to previous position on line
-                  break;
-               case 'V':
-               case 'v':                                    // <ESC><^Z><u> print variables
-                  printf("\n");
-                  printf("%s %s\n",    "autoLineFeed:      ",autoLineFeed?"true":"false");
-                  printf("%s %s\n",    "autoCarriageReturn:",autoCarriageReturn?"true":"false");
-                  printf("%s %s\n",    "initializing:      ",initializing?"true":"false");
-                  printf("%s %s\n",    "monitor:           ",monitor?"true":"false");
-                  printf("%s %s\n",    "localMode:         ",localMode?"true":"false");
-                  printf("%s" PATTERN, "attribute:         ",TO_BINARY(attribute));
-                  printf("%s %d\n",    "column:            ",(int)column);
-                  printf("%s %d\n",    "tabStop:           ",(int)tabStop);
-                  printf("%s 0x%02X\n","printWheel:        ",(int)printWheel);
-                  printf("%s %d\n",    "uSpacesPerChar:    ",(int)uSpacesPerChar);
-                  printf("%s %d\n",    "uLinesPerLine:     ",(int)uLinesPerLine);
-                  printf("%s %d\n",    "uSpaceCount:       ",(int)uSpaceCount);
-                  for(c=1; c<column; c++) putchar(SP);      // return cursor to previous position on line
-                  break;
-               case 'W':
-               case 'w':                                    // <ESC><^Z><w> print watchdog resets
-                  printf("\n%s %d\n","Watch Dog Timer resets:",(int)wdResets);
-                  for(c=1; c<column; c++) putchar(SP);      // return cursor to previous position on line
-                  break;
-            } // switch(key)
-            break;  // case 2:
-        case 3:                                             // <ESC><^Z><p> has been detected. this is the fourth character of the escape sequence
-            escape = 0;
-            switch(key){
-                case '0':
-                    printf("%s 0x%02X\n","P0:",(int)P0);    // <ESC><^Z><p><0> print port 0 value
-                    break;
-                case '1':
-                    printf("%s 0x%02X\n","P1:",(int)P1);    // <ESC><^Z><p><1> print port 1 value
-                    break;
-                case '2':
-                    printf("%s 0x%02X\n","P2:",(int)P2);    // <ESC><^Z><p><2> print port 2 value
-                    break;
-                case '3':
-                    printf("%s 0x%02X\n","P3:",(int)P3);    // <ESC><^Z><p><3> print port 3 value
-                    break;
-                case '4':
-                    printf("%s 0x%02X\n","P4:",(int)P4);    // <ESC><^Z><p><3> print port 4 value
-                    break;
-                case '5':
-                    printf("%s 0x%02X\n","P5:",(int)P5);    // <ESC><^Z><p><3> print port 5 value
-                    break;
-            } // switch(charToPrint)
-            break;  // case 3:
-        case 4:                                             // <ESC><^Z><e> has been detected. this is the fourth character of the escape sequence
-            escape = 0;
-            if (key & 0x01)
-                errorLED = TRUE;                            // <ESC><^Z><e><n> odd values of n turn the LED on, even values turn the LED off
-            else {
-                errorLED = FALSE;
-                redLED = OFF;                               // turn off the red LED
-            }
-            break;  // case 4
-        case 5:
-            if (key == 0x20) {                              // if it's SPACE...
-                printf(help2);                              // print the second half of the help text
-                escape = 0;
-            }
-            else if (key == ESC) {                          // if it's ESCAPE, exit
-                putchar(0x0D);
-                escape = 0;
-            }
-            break; // case 5
-    } // switch(escape)
-}
-
-//-----------------------------------------------------------
-// main(void)
-//-----------------------------------------------------------
-void main(void){
-    unsigned int loopcounter,function_board_cmd,printer_board_reply;
-    unsigned char state = 0;
-    unsigned char wwKey,ch;
-    unsigned char lastsec = 0;
-
-    // from the data sheet:
-    // "After power-up, all PWM-related I/O ports on the IAP15W4K61S4 are in high impedance state.
-    // These ports need to be set to quasi-bidirectional or strong push-pull mode for normal use."
-    // Affected ports: P0.6,P0.7,P1.6,P1.7,P2.1,P2.2,P2.3,P2.7,P3.7,P4.2,P4.4,P4.5
-    P0M1 = 0;                                               // set P0 to quasi-bidirectional
-    P0M0 = 0;
-
-    TL0 = RELOADLO;                                         // load timer 0 low byte
-    TH0 = RELOADHI;                                         // load timer 0 high byte
-    TMOD = 0x00;                                            // configure timer 0 for mode 0: 16-bit auto-reload timer
-    ET0 = 1;                                                // enable timer 0 interrupt
-    TR0 = 1;                                                // run timer 0
-    uart1_init(115200);                                     // initialize UART1 for N-8-1 at 115200bps for debug/monitor
-    uart2_init(9600);                                       // initialize UART2 for N-8-1 at 9600bps, RTS-CTS handshaking for host PC
-    uart3_init();                                           // initialize UART3 for N-9-1 at 187500bps for connection to the Function Board
-    uart4_init();                                           // initialize UART4 for N-9-1 at 187500bps for connection to the Printer Board
-
-    EA = TRUE;                                              // global interrupt enable
-
-    printf("\n%s\n",about);
-    if (POF) {
-        printf ("Power-on reset\n");
-        wdResets = 0;
-        softResetFlag = 0;
-        CLR_POF;
-    }
-
-    else if (WDT_FLAG){
-         printf("%s %d\n","Watch Dog Timer resets:",(int)++wdResets);
-         CLR_WDT_FLAG;
-    }
-
-    else if (softResetFlag == 0x55) {
-        printf ("Software reset\n");
-        softResetFlag = 0;
-    }
-
-    printf("Initializing");
-    lastsec = seconds;
-    ww_reset(3);                                            // reset both boards                                                    // initialize ww vars and reset both boards
-    WDT_CONTR |= 0x06;                                      // watch dog timer overflows in 4194.3 mS
-    ENABLE_WDT;                                             // run watch dog timer
-
-    //////////// determine the pitch of the printwheel /////////////
-    printWheel = 0;
-    timeout = ONESEC*6;
-    while(!printWheel && timeout) {                         // loop for up to 6 seconds or until the printer board replies to 0x121,0x001...
-        if (lastsec != seconds) {                           // once each second...
-            lastsec = seconds;
-            putchar('.');                                   // dots on screen to monitor progress
-            RESET_WDT;                                      // reset watch dog timer every second
-        }
-
-        if (function_board_cmd_avail()){                    // if there's a command from the function board...
-            function_board_cmd = get_function_board_cmd();  // retrieve the command from UART3
-            send_to_printer_board(function_board_cmd);      // relay the command to the printer board
-            switch(state) {
-                case 0:
-                    if (function_board_cmd == 0x121) state = 1;
-                    break;
-                case 1:
-                    if (function_board_cmd == 0x001) state = 2;
-                    else state = 0;                         // 0x121,0x001 is the "reset" command  from the function board
-            }
-        }
-
-        if (printer_board_reply_avail()) {                  // if there's a reply from the Printer Board...
-            printer_board_reply = get_printer_board_reply();// retrieve the reply from UART4
-            send_to_function_board(printer_board_reply);    // relay replies from the Printer Board to the Function Board
-            if (state == 2) {                               // if the reset command has been sent, the reply from the printer board is the printwheel pitch
-               printWheel = printer_board_reply;            // we now know the pitch of the printwheel, exit the loop
-               switch(printWheel) {
-                  case 0x008:
-                     printf("\nPS printwheel\n");
-                     tabStop = 5;                           // tab stops every 5 characters (every 1/2 inch)
-                     uSpacesPerChar = 10;                   // 10 micro spaces/character
-                     uLinesPerLine = 16;                    // 16 micro lines/full line
-                     break;
-                  case 0x010:
-                     printf("\n15P printwheel\n");
-                     tabStop = 7;                           // tab stops every 7 characters (every 1/2 inch)
-                     uSpacesPerChar = 8;
-                     uLinesPerLine = 12;
-                     break;
-                  case 0x020:
-                     printf("\n12P printwheel\n");
-                     tabStop = 6;                           // tab stops every 6 characters (every 1/2 inch)
-                     uSpacesPerChar = 10;                   // 10 micro spaces/character
-                     uLinesPerLine = 16;                    // 16 micro lines/full line
-                     break;
-                  case 0x021:
-                     printf("\nNo printwheel\n");
-                     tabStop = 6;                           // tab stops every 6 characters (every 1/2 inch)
-                     uSpacesPerChar = 10;                   // 10 micro spaces/character
-                     uLinesPerLine = 16;                    // 16 micro lines/full line
-                     break;
-                  case 0x040:
-                     printf("\n10P printwheel\n");
-                     tabStop = 5;                           // tab stops every 5 characters (every 1/2 inch)
-                     uSpacesPerChar = 12;                   // 10 micro spaces/character
-                     uLinesPerLine = 16;                    // 16 micro lines/full line
-                     break;
-                  default:
-                     printf("\nUnable to determine printwheel. Defaulting to 12P.\n");
-                     printf("0x%02X\n",(int)printWheel);
-                     tabStop = 6;                           // tab stops every 6 characters (every 1/2 inch)
-                     uSpacesPerChar = 10;                   // 10 micro spaces/character
-                     uLinesPerLine = 16;                    // 16 micro lines/full line
-                     errorLED=TRUE;
-               } // switch(printWheel)
-            } // if (state == 2)
-        } // if (printer_board_reply_avail())
-    } // while(!printWheel)
-
-    if (!timeout)                                           // turn on error light if unable to determine printwheel
-       errorLED = TRUE;
-       
-    //////////// relay the remaining initialization commands from Function to Printer board /////////////
-    timeout = ONESEC;                                       // empirically determined 1 second is adequate
-    while(timeout) {                                        // loop for one second
-        RESET_WDT;                                          // reset watch dog timer
-
-        if (function_board_cmd_avail()){                    // if there's a command from the function board...
-            function_board_cmd = get_function_board_cmd();
-            //printf("%03X\n",function_board_cmd);
-            send_to_printer_board(function_board_cmd);      // relay the command to the printer board
-        }
-
-        if (printer_board_reply_avail()) {                  // if there's a reply from the Printer Board...
-            printer_board_reply = get_printer_board_reply();
-            //printf("%03X\n",printer_board_reply);
-            send_to_function_board(printer_board_reply);    // relay replies from the Printer Board to the Function Board
-        }
-    }
-
-    printf("<ESC> H for help\n");
-    printf("Ready\n");
-    initializing = FALSE;
-    amberLED = OFF;                                         // turn off the amber LED
-    greenLED = OFF;                                         // turn off the green LED
-    redLED = OFF;                                           // turn off the red LED
-    loopcounter = 0;
-
-    //----------------- loop here forever -----------------------------------------
-    while(TRUE) {
-
-        RESET_WDT;                                              // reset the watch dog timer each pass thru the loop
-
-        if (++loopcounter==0) {                                 // every 65536 passes through the loop (at about 2Hz)
-            greenLED = !greenLED;                               // toggle the green "heart beat" LED
-        }
-
-        //////////// check for key press codes coming from the Function Board ////////////
-        if (function_board_cmd_avail()) {                       // if there's a command from the Function Board...
-            function_board_cmd = get_function_board_cmd();      // retrieve it from UART3
-            send_ACK_to_function_board();                       // mimic Printer Board by sending Acknowledge to Function Board
-            if (monitor) printf("%03X\n",function_board_cmd);   // if the monitor flag is set...
-
-            wwKey = ww_decode_keys(function_board_cmd);         // convert the function board keystroke cmd into ASCII character
-            if (wwKey) {                                        // if it's a valid ASCII key...
-                if (wwKey == 0xF0) {                            // is it Code+Erase key combo?
-                    if (column == 1) {                          // carrier must be at left margin to change modes
-                        localMode = !localMode;                 // toggle the line/local flag
-                        ww_spin();                              // spin the printwheel
-                        ww_paper_up();                          // up 1/2 line, then
-                        ww_paper_down();                        // down 1/2 line as a visual indication
-                    }
-                }
-                else {
-                    if (localMode) 
-                       print_char_on_WW(wwKey);                 // if 'local' mode, print the ASCII character on the Wheelwriter
-                    else 
-                       putchar2(wwKey);                         // else print the ASCII character on the console
-                }
-            }
-        }
-
-        //////////// check for characters to print coming from the serial console (UART2)     ////////////
-        if (char_avail2()) {                                    // if there is a character in the serial receive buffer...
-            ch = getchar2();                                    // retrieve the character from UART2
-            print_char_on_WW(ch);                               // send it to the Wheelwriter for printing
-        }
-
-        //////////// check for characters to coming from the debug serial connection (UART1) ////////////
-        if (char_avail1()) {
-           ch = getchar1();
-           process_key(ch);
-        }
-    } //----------------- end of loop -----------------------------------------
-}
+//------------------------------------------------------------------------------------------
+// Uses an STCmicro IAP15W4K32S4 series micro controller to turn an IBM Wheelwriter Electronic
+// Typewriter into a teletype-like device.
+//
+// For the Small Device C Compiler (SDCC)
+//
+// UART1 used for debugging, monitor and in-application-programming - 115200bps N-8-1
+// UART2 used for communications with host PC - 9600 or 115200bps N-8-1
+// UART3 used for communications with Wheelwriter Function Board
+// UART4 used for communications with Wheelwriter Printer Board
+//
+// Version 1.0.0 - Initial version
+// Version 1.1.0 - Changes necessary to make compatible with Wheelwriter 3, 5 and 6
+// Version 1.1.1 - Renamed some functions and variables for added readability
+// Version 1.2.0 - Watch Dog Timer added
+// Version 1.3.0 - reworked main() and ww_decode_key() functions
+// Version 1.3.1 - removed wheelwriter model detection code
+// Version 1.3.2 - revised line/local mode, diagnostics display
+// Version 1.3.3 - revised wheelwriter.c for ASCII Printwheel (part no. 1353909)
+// Version 1.3.4 - use UART1 for debugging and monitor
+// Version 1.3.5 - SDCC version
+// Version 1.4.0 - commands for the Printer Board are queued and sent by the UART4 ISR
+// Version 1.4.1 - line buffering with bidirectional printing
+// Version 1.4.2 - spaces, tabs, backspaces and carriage returns coalesced into single carrier moves
+// Version 1.4.3 - vertical movement coalesced into single paper moves, form feed
+// Version 1.4.4 - printwheel-aware strike ordering for bidirectional printing
+// Version 1.4.5 - underlining printed in a separate sweep when printing bidirectionally
+// Version 1.4.6 - draft mode
+// Version 1.4.7 - 2K print spool for UART2
+// Version 1.4.8 - host baud rate selectable at run time, power-on default saved in EEPROM
+// Version 1.4.9 - interrupt driven transmit buffers for UART1 and UART2
+// Version 1.5.0 - Function Board keystrokes acknowledged by the UART3 ISR
+// Version 1.5.1 - passthrough mode relays Function Board commands directly to the Printer Board
+// Version 1.5.2 - time stamped bus trace
+// Version 1.5.3 - Diablo 630 emulation moved to diablo.c, hal.h lets it compile on Linux
+// Version 1.5.4 - built-in benchmark
+// Version 1.5.5 - free running microsecond time base, 50 millisecond ticks derived from it
+// Version 1.5.6 - Printer Board latency histograms for each kind of command
+// Version 1.5.7 - host to strike latency percentiles
+// Version 1.5.8 - calibration of the printwheel and carrier timing for strike ordering
+// Version 1.5.9 - interrupt priorities set explicitly, bus receive buffer overruns counted, stress test
+// Version 1.6.0 - overruns, high-water marks and totals for all four receive buffers, red LED on any loss
+// Version 1.6.1 - print spool sized to keep xdata clear of the watchdog reset counters, spool watermarks saved in EEPROM
+//
+// NOTE: When using STCmicro's stc-isp application to download object code to the MCU,
+//       make sure the internal clock frequency is set to 12 MHz.
+//
+//------------------------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------------------------------------------------------------------
+// Copyright 2019-2025 Jim Loos
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated documentation files
+// (the "Software"), to deal in the Software without restriction, including without limitation the rights to use, copy, modify, merge,
+// publish, distribute, sub-license, and/or sell copies of the Software, and to permit persons to whom the Software is furnished to do
+// so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+// OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+// IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+//-------------------------------------------------------------------------------------------------------------------------------------
+
+#include <compiler.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include "reg51.h"
+#include "stc51.h"
+#include "control.h"
+#include "uart1.h"
+#include "uart2.h"
+#include "ww-uart3.h"
+#include "ww-uart4.h"
+#include "wheelwriter.h"
+#include "eeprom.h"
+#include "trace.h"
+#include "diablo.h"
+#include "bench.h"
+#include "timebase.h"
+#include "profile.h"
+#include "latency.h"
+#include "calibrate.h"
+#include "stress.h"
+
+#define FALSE 0
+#define TRUE  1
+#define LOW 0
+#define HIGH 1
+#define ON 0                            // 0 turns the LEDs on
+#define OFF 1                           // 1 turns the LEDs off
+
+// 12,000,000 Hz/12 = 1,000,000 Hz = 1.0 microsecond clock period
+// Timer 0 runs free and overflows every 65,536 microseconds. the 50 millisecond ticks are
+// counted off the overflows: one per overflow, plus one more each time the 15,536 microseconds
+// left over add up to another 50,000.
+#define OVERFLOWUSEC 65536
+#define TICKUSEC 50000
+#define ONESEC 20                       // 20*50 milliseconds = 1 second
+#define IDLEFLUSH (ONESEC/2)            // host silence before a partial line is printed, unless set by <ESC><I><n>
+
+__sbit __at (0x85) redLED;              // red   LED connected to pin 6 0=on, 1=off
+__sbit __at (0x86) amberLED;            // amber LED connected to pin 7 0=on, 1=off
+__sbit __at (0x87) greenLED;            // green LED connected to pin 8 0=on, 1=off
+
+__bit errorLED = FALSE;                 // makes the red LED flash when TRUE
+__bit initializing = TRUE;              // makes all three LEDs flash during initialization
+__bit monitor = FALSE;                  // monitor communications between function and printer boards
+__bit localMode = TRUE;                 // when true wheelwriter keystrokes go to wheelwriter, when false wheelwriter keystrokes go to serial console
+__bit passthrough = FALSE;              // when true Function Board commands are relayed unchanged to the Printer Board
+
+unsigned char printWheel = 0;           // 10pt, 12pt, 15pt or PS
+unsigned long __xdata hostBaudRate;     // UART2 baud rate, 9600 or 115200
+unsigned char __xdata idleFlush;        // 50 millisecond ticks of host silence before a partial line is printed, 0=never
+__bit hostIdle = FALSE;                 // set once the host has stopped sending, until it sends again
+
+extern __bit autoLineFeed;              // automatic linefeed with carriage return; defined in diablo.c
+extern __bit autoCarriageReturn;        // automatic carriage return with linefeed; defined in diablo.c
+extern unsigned char attribute;         // bold and underlining; defined in diablo.c
+extern unsigned char draftMask;         // attribute bits ignored in draft mode; defined in diablo.c
+extern unsigned char column;            // current print column; defined in diablo.c
+extern unsigned char tabStop;           // horizontal tab spacing; defined in diablo.c
+extern unsigned char uSpacesPerChar;    // micro spaces per character; defined in wheelwriter.c
+extern unsigned char uLinesPerLine;     // micro lines per line; defined in wheelwriter.c
+extern unsigned int  uSpaceCount;       // number of micro spaces on the current line; defined in wheelwriter.c
+extern unsigned int  uSpaceTarget;      // micro space position of the next buffered character; defined in wheelwriter.c
+extern __bit lineBuffering;             // line buffering and bidirectional printing; defined in wheelwriter.c
+extern __bit strikeOrdering;            // printwheel-aware strike ordering; defined in wheelwriter.c
+extern unsigned int __xdata uLinePosition; // micro lines from the top of form; defined in wheelwriter.c
+extern unsigned int __xdata uLinesPerPage; // micro lines per page; defined in wheelwriter.c
+
+volatile unsigned char timeout = 0;     // decremented every 50 milliseconds, used for detecting timeouts
+volatile unsigned char hours = 0;       // uptime hours
+volatile unsigned char minutes = 0;     // uptime minutes
+volatile unsigned char seconds = 0;     // uptime seconds
+
+// uninitialized variables in xdata RAM, contents unaffected by reset. the linker
+// keeps all other xdata below 0xEF0 (--xram-size in build.bat)
+volatile __xdata __at (0xEF0) unsigned char wdResets;
+volatile __xdata __at (0xEF1) unsigned char softResetFlag;
+
+__code char about[] = "Wheelwriter Teletype Version 1.6.1\n"
+                      "for STCmicro IAP15W4K61S4 MCU and SDCC Compiler\n"
+                      "Compiled on " __DATE__ " at " __TIME__"\n"
+                      "Copyright 2019-2025 Jim Loos\n";
+
+__code char help1[] = "\n\nControl characters:\n"
+                      "  BEL 0x07        spins the printwheel\n"
+                      "  BS  0x08        non-destructive backspace\n"
+                      "  TAB 0x09        horizontal tab\n"
+                      "  LF  0x0A        paper up one line\n"
+                      "  VT  0x0B        paper up one line\n"
+                      "  FF  0x0C        paper up to the next top of form\n"
+                      "  CR  0x0D        returns carriage to left margin\n"
+                      "  ESC 0x1B        see Diablo 630 commands below...\n"
+                      "\nDiablo 630 commands emulated:\n"
+                      "  <ESC><O>        selects bold printing\n"
+                      "  <ESC><&>        cancels bold printing\n"
+                      "  <ESC><E>        selects continuous underlining\n"
+                      "  <ESC><R>        cancels underlining\n"
+                      "  <ESC><X>        cancels both bold and underlining\n"
+                      "  <ESC><U>        half line feed\n"
+                      "  <ESC><D>        reverse half line feed\n"
+                      "  <ESC><BS>       backspace 1/120 inch\n"
+                      "  <ESC><LF>       reverse line feed\n"
+                      "  <ESC></>        enables bidirectional printing\n"
+                      "  <ESC><\\>        disables bidirectional printing\n"
+                      "  <ESC><FF><n>    sets page length to n lines\n"
+                      "  <ESC><T>        sets top of form at the current line\n"
+                      "<Space> for more, <ESC> to exit...";
+__code char help2[] = "\n\nPrinter control not part of the Diablo 630 emulation:\n"
+                      "  <ESC><u>        selects micro paper up\n"
+                      "  <ESC><d>        selects micro paper down\n"
+                      "  <ESC><b>        selects broken underlining\n"
+                      "  <ESC><l><n>     auto linefeed on or off\n"
+                      "  <ESC><c><n>     auto carriage return on or off\n"
+                      "  <ESC><o><n>     strike ordering on or off\n"
+                      "  <ESC><q><n>     draft mode: 1 plain bold, 2 no underline, 3 both\n"
+                      "  <ESC><s><n>     host baud rate 9600 or 115200\n"
+                      "  <ESC><S><n>     saves power-on host baud rate\n"
+                      "  <ESC><W><p><r>  saves spool pause and resume levels\n"
+                      "  <ESC><I><n>     saves host idle time before a partial line prints\n"
+                      "  <ESC><p>        selects Pica pitch\n"
+                      "  <ESC><e>        selects Elite pitch\n"
+                      "  <ESC><m>        selects Micro Elite pitch\n"
+                      "\nDiagnostics/debugging:\n"
+                      "  <ESC><^Z><a>    show version information\n"
+                      "  <ESC><^Z><b>    print the benchmark pattern and timing\n"
+                      "  <ESC><^Z><c><n> start or stop the bus trace\n"
+                      "  <ESC><^Z><d>    dump the bus trace\n"
+                      "  <ESC><^Z><e>    show host to strike latency\n"
+                      "  <ESC><^Z><h>    dump the Printer Board latency histograms\n"
+                      "  <ESC><^Z><k>    calibrate the strike ordering cost model\n"
+                      "  <ESC><^Z><l><n> turn flashing red error LED on or off\n"
+                      "  <ESC><^Z><m>    monitor Function Board commands\n"
+                      "  <ESC><^Z><p><n> show value of Port n (0-5)\n"
+                      "  <ESC><^Z><r>    reset the Wheelwriter\n"
+                      "  <ESC><^Z><s>    show receive buffer statistics\n"
+                      "  <ESC><^Z><t>    passthrough mode on or off\n"
+                      "  <ESC><^Z><u>    show uptime\n"
+                      "  <ESC><^Z><v>    show variables\n"
+                      "  <ESC><^Z><w>    show number of watchdog resets\n"
+                      "  <ESC><^Z><x>    stress test all four UARTs\n"
+                      "\nCode+Erase on Wheelwriter toggles line/local mode\n\n";
+
+//---------------------------------------------------------------------------------
+// Note that the two function below, _getkey() and putchar(), replace the library
+// functions of the same name.  These functions use the interrupt-driven serial
+// I/O routines in uart1.c
+//---------------------------------------------------------------------------------
+// for scanf
+char _getkey(void) {
+    return getchar1();              // return character from uart1
+}
+
+// for printf
+int putchar(int c)  {
+   return putchar1(c);              // send character to uart1
+}
+
+//------------------------------------------------------------
+// Timer 0 ISR: interrupt every 65.536 milliseconds when the free running Timer 0
+// overflows. counts the overflows for the time stamp, then does the work of each
+// 50 millisecond tick that has elapsed: the timeout countdown, the LEDs and the uptime.
+//------------------------------------------------------------
+void timer0_isr(void) __interrupt(1) __using(1) {
+    static unsigned char ticks = 0;
+    static unsigned int remainder = 0;  // microseconds towards the next 50 millisecond tick
+    unsigned char n = 1;
+
+    ++timeHigh;                         // upper 16 bits of the time stamp
+    remainder += OVERFLOWUSEC-TICKUSEC;
+    if (remainder >= TICKUSEC) {        // the left over microseconds make another tick
+        remainder -= TICKUSEC;
+        ++n;
+    }
+
+    while (n--) {
+        if (timeout) {                  // countdown value for detecting timeouts
+            --timeout;
+        }
+
+        if (initializing) {             // flash all three LEDs at 2Hz while initializing
+           amberLED = greenLED = redLED = (ticks < 10);
+        }
+
+        if (errorLED) {                 // flash red LED at 2Hz if error
+            redLED = (ticks < 10);
+        }
+
+        if(++ticks == 20) {             // if 20 ticks (one second) have elapsed...
+            ticks = 0;
+
+            if (++seconds == 60) {      // if 60 seconds (one minute) has elapsed...
+                seconds = 0;
+                if (++minutes == 60) {  // if 60 minutes (one hour) has elapsed...
+                    minutes = 0;
+                    ++hours;
+                }
+            }
+        }
+    }
+}
+
+//-------------------------------------------------------------------------------------------
+// Turns passthrough mode on or off. Anything already buffered is printed and acknowledged
+// before the Function Board is connected through to the Printer Board. While passthrough is
+// on, the Printer Board acknowledges the Function Board instead of the UART3 ISR. When
+// passthrough ends, the column is recomputed from the carrier position tracked by
+// ww_decode_keys().
+//-------------------------------------------------------------------------------------------
+void passthrough_mode(unsigned char on) {
+    if (on) {
+        ww_flush();                                         // print anything in the line buffer
+        while (printer_board_busy());                       // wait for the Printer Board to acknowledge it all
+        function_board_ack(FALSE);                          // the Printer Board's acknowledge is relayed instead
+        passthrough = TRUE;
+    }
+    else {
+        passthrough = FALSE;
+        function_board_ack(TRUE);
+        column = uSpaceCount/uSpacesPerChar+1;
+    }
+}
+
+#define PATTERN " %c%c%c%c%c%c%c%c\n"
+#define TO_BINARY(byte)  \
+  (byte & 0x80 ? '1' : '0'), \
+  (byte & 0x40 ? '1' : '0'), \
+  (byte & 0x20 ? '1' : '0'), \
+  (byte & 0x10 ? '1' : '0'), \
+  (byte & 0x08 ? '1' : '0'), \
+  (byte & 0x04 ? '1' : '0'), \
+  (byte & 0x02 ? '1' : '0'), \
+  (byte & 0x01 ? '1' : '0')
+
+//------------------------------------------------------------------------------------------
+// Process keystrokes from the UART1 monitor/debug serial connection
+//
+// for diagnostics/debugging:
+//   <ESC><h>        display help
+//   <ESC><^Z><a>    show version information
+//   <ESC><^Z><b>    benchmark. prints a test pattern (strikes, bold, underline, tabs, carriage returns
+//                   and line feeds), then the time, bus words and acknowledge waits of each phase
+//   <ESC><^Z><c><n> bus trace (n=1 empties the trace buffer and starts recording, n=0 stops recording)
+//   <ESC><^Z><d>    stop recording and dump the bus trace in hex, one word per line
+//   <ESC><^Z><e>    show and reset the 50th and 99th percentile and longest time from a character
+//                   arriving from the host to its strike being acknowledged by the Printer Board.
+//                   one character is timed at a time, so it's a sample: the count of characters
+//                   timed is shown against the count received
+//   <ESC><^Z><h>    dump and empty the histograms of the time the Printer Board takes to acknowledge
+//                   each kind of command (strikes, carrier and paper movement, etc.)
+//   <ESC><^Z><k>    calibrate. prints a line of strikes and moves the carrier and paper, times each
+//                   movement, then saves the printwheel and carrier costs used by strike ordering in
+//                   the EEPROM
+//   <ESC><^Z><l><n> turn flashing red error LED on or off (n=1 is on, n=0 is off)
+//   <ESC><^Z><m>    monitor Function Board commands
+//   <ESC><^Z><p><n> show the value of Port n (0-5) as 2 digit hex number
+//   <ESC><^Z><r>    reset both the MCU and the wheelwriter
+//   <ESC><^Z><s>    show the size, high-water mark, overruns and total received of the UART1, UART2,
+//                   UART3 and UART4 receive buffers. any overrun also turns on the flashing red LED
+//   <ESC><^Z><t>    toggle passthrough mode. Function Board commands are relayed unchanged to the
+//                   Printer Board and the Printer Board's replies relayed back, as the boards would
+//                   do if connected directly. keystrokes are still decoded and, in line mode, sent
+//                   to the host. nothing from the host is printed while in passthrough mode.
+//   <ESC><^Z><u>    show uptime as HH:MM:SS
+//   <ESC><^Z><v>    show variables
+//   <ESC><^Z><w>    show number of watchdog resets
+//   <ESC><^Z><x>    stress test. sends monitor lines on UART1 without pause while printing whatever
+//                   the host sends, until a key is pressed, then shows any Wheelwriter bus words lost
+//-------------------------------------------------------------------------------------------
+void process_key(unsigned char key) {
+    static unsigned char escape = 0;                        // escape sequence state
+    unsigned char c;
+
+    switch(escape) {
+        case 0:                                             // first character
+            switch(key) {
+                case ESC:
+                    escape = 1;                             // ESCAPE character detected, next state
+                    break;
+            } // switch(key)
+            break;  // case 0:
+        case 1:
+            escape = 0;                                     // <ESC> has been detected, this is the second character of the escape sequence...
+            switch(key) {
+                case '\x1A':                                // <ESC><^Z> for remote diagnostics
+                    escape = 2;
+                    break;
+                case 'H':
+                case 'h':
+                    printf(help1);                          // print the first half of the help
+                    escape = 5;                             // wait for a key to be pressed...
+                    break;
+            } // switch(key)
+            break;  // case 1:
+        case 2:                                             // <ESC><^Z> detected, this is the third character of the escape sequence...
+            escape = 0;
+            switch(key) {
+               case 'A':
+               case 'a':                                    // <ESC><^Z><a> print version info
+                  printf("\n%s\n",about);
+                  for(c=1; c<column; c++) putchar(SP);      // return cursor to previous position on line
+                  break;
+               case 'L':
+               case 'l':                                    // <ESC><^Z><l> controls the red error LED. the next character turn is on or off
+                  escape = 4;
+                  break;
+               case 'B':
+               case 'b':                                    // <ESC><^Z><b> run the benchmark
+                  bench_run();
+                  break;
+               case 'C':
+               case 'c':                                    // <ESC><^Z><c> controls the bus trace. the next character starts or stops it
+                  escape = 6;
+                  break;
+               case 'D':
+               case 'd':                                    // <ESC><^Z><d> dump the bus trace
+                  trace_dump();
+                  for(c=1; c<column; c++) putchar(SP);      // return cursor to previous position on line
+                  break;
+               case 'E':
+               case 'e':                                    // <ESC><^Z><e> show the host to strike latency
+                  latency_report();
+                  for(c=1; c<column; c++) putchar(SP);      // return cursor to previous position on line
+                  break;
+               case 'H':
+               case 'h':                                    // <ESC><^Z><h> dump the Printer Board latency histograms
+                  profile_dump();
+                  for(c=1; c<column; c++) putchar(SP);      // return cursor to previous position on line
+                  break;
+               case 'K':
+               case 'k':                                    // <ESC><^Z><k> calibrate the mechanical timing
+                  calibrate_run();
+                  break;
+               case 'M':
+               case 'm':                                    // <ESC><^Z><m> monitor communications
+                   monitor = !monitor;                      // toggle monitor flag
+                  break;
+               case 'P':
+               case 'p':                                    // <ESC><^Z><p> print port values. the next character selects the port number
+                  escape = 3;
+                  break;
+               case 'R':
+               case 'r':                                    // <ESC><^Z><r> reset the MCU and the Wheelwriter
+                  ww_reset(3);                              // reset both Wheelwriter boards
+                  softResetFlag = 0x55;                     // set the flag
+                  flush1();                                 // finish sending anything in the UART1 transmit buffer
+                  IAP_CONTR = 0x20;                         // reset the MCU
+                  break;
+               case 'U':
+               case 'u':                                    // <ESC><^Z><u> print uptime
+                  printf("\n%s %02u%c%02u%c%02u\n","Uptime:",(int)hours,':',(int)minutes,':',(int)seconds);
+                  for(c=1; c<column; c++) putchar(SP);      // return cursor to previous position on line
+                  break;
+               case 'V':
+               case 'v':                                    // <ESC><^Z><u> print variables
+                  printf("\n");
+                  printf("%s %s\n",    "autoLineFeed:      ",autoLineFeed?"true":"false");
+                  printf("%s %s\n",    "autoCarriageReturn:",autoCarriageReturn?"true":"false");
+                  printf("%s %s\n",    "initializing:      ",initializing?"true":"false");
+                  printf("%s %s\n",    "monitor:           ",monitor?"true":"false");
+                  printf("%s %s\n",    "localMode:         ",localMode?"true":"false");
+                  printf("%s %s\n",    "passthrough:       ",passthrough?"true":"false");
+                  printf("%s %s\n",    "lineBuffering:     ",lineBuffering?"true":"false");
+                  printf("%s %s\n",    "strikeOrdering:    ",strikeOrdering?"true":"false");
+                  printf("%s" PATTERN, "attribute:         ",TO_BINARY(attribute));
+                  printf("%s" PATTERN, "draftMask:         ",TO_BINARY(draftMask));
+                  printf("%s %d\n",    "column:            ",(int)column);
+                  printf("%s %d\n",    "tabStop:           ",(int)tabStop);
+                  printf("%s 0x%02X\n","printWheel:        ",(int)printWheel);
+                  printf("%s %d\n",    "uSpacesPerChar:    ",(int)uSpacesPerChar);
+                  printf("%s %d\n",    "uLinesPerLine:     ",(int)uLinesPerLine);
+                  printf("%s %d\n",    "uSpaceCount:       ",(int)uSpaceCount);
+                  printf("%s %d\n",    "uSpaceTarget:      ",(int)uSpaceTarget);
+                  printf("%s %d\n",    "uLinePosition:     ",(int)uLinePosition);
+                  printf("%s %d\n",    "uLinesPerPage:     ",(int)uLinesPerPage);
+                  printf("%s %u\n",    "spooled:           ",spooled2());
+                  printf("%s %lu\n",   "hostBaudRate:      ",hostBaudRate);
+                  printf("%s %d\n",    "idleFlush:         ",(int)idleFlush);
+                  for(c=1; c<column; c++) putchar(SP);      // return cursor to previous position on line
+                  break;
+               case 'S':
+               case 's':                                    // <ESC><^Z><s> print receive buffer statistics
+                  printf("\nRINGS\n%-12s %5s %10s %9s %11s\n","buffer","size","high water","overruns","received");
+                  uart1_stats();
+                  uart2_stats();
+                  uart3_stats();
+                  uart4_stats();
+                  printf(".\n");
+                  for(c=1; c<column; c++) putchar(SP);      // return cursor to previous position on line
+                  break;
+               case 'T':
+               case 't':                                    // <ESC><^Z><t> toggle passthrough mode
+                  passthrough_mode(!passthrough);
+                  printf("\n%s %s\n","Passthrough mode",passthrough?"on":"off");
+                  for(c=1; c<column; c++) putchar(SP);      // return cursor to previous position on line
+                  break;
+               case 'W':
+               case 'w':                                    // <ESC><^Z><w> print watchdog resets
+                  printf("\n%s %d\n","Watch Dog Timer resets:",(int)wdResets);
+                  for(c=1; c<column; c++) putchar(SP);      // return cursor to previous position on line
+                  break;
+               case 'X':
+               case 'x':                                    // <ESC><^Z><x> stress test
+                  stress_run();
+                  for(c=1; c<column; c++) putchar(SP);      // return cursor to previous position on line
+                  break;
+            } // switch(key)
+            break;  // case 2:
+        case 3:                                             // <ESC><^Z><p> has been detected. this is the fourth character of the escape sequence
+            escape = 0;
+            switch(key){
+                case '0':
+                    printf("%s 0x%02X\n","P0:",(int)P0);    // <ESC><^Z><p><0> print port 0 value
+                    break;
+                case '1':
+                    printf("%s 0x%02X\n","P1:",(int)P1);    // <ESC><^Z><p><1> print port 1 value
+                    break;
+                case '2':
+                    printf("%s 0x%02X\n","P2:",(int)P2);    // <ESC><^Z><p><2> print port 2 value
+                    break;
+                case '3':
+                    printf("%s 0x%02X\n","P3:",(int)P3);    // <ESC><^Z><p><3> print port 3 value
+                    break;
+                case '4':
+                    printf("%s 0x%02X\n","P4:",(int)P4);    // <ESC><^Z><p><3> print port 4 value
+                    break;
+                case '5':
+                    printf("%s 0x%02X\n","P5:",(int)P5);    // <ESC><^Z><p><3> print port 5 value
+                    break;
+            } // switch(charToPrint)
+            break;  // case 3:
+        case 4:                                             // <ESC><^Z><e> has been detected. this is the fourth character of the escape sequence
+            escape = 0;
+            if (key & 0x01)
+                errorLED = TRUE;                            // <ESC><^Z><e><n> odd values of n turn the LED on, even values turn the LED off
+            else {
+                errorLED = FALSE;
+                redLED = OFF;                               // turn off the red LED
+            }
+            break;  // case 4
+        case 5:
+            if (key == 0x20) {                              // if it's SPACE...
+                printf(help2);                              // print the second half of the help text
+                escape = 0;
+            }
+            else if (key == ESC) {                          // if it's ESCAPE, exit
+                putchar(0x0D);
+                escape = 0;
+            }
+            break; // case 5
+        case 6:                                             // <ESC><^Z><c> has been detected. this is the fourth character of the escape sequence
+            escape = 0;
+            trace_arm(key & 0x01);                          // <ESC><^Z><c><n> odd values of n start the trace, even values stop it
+            break; // case 6
+    } // switch(escape)
+}
+
+//-----------------------------------------------------------
+// main(void)
+//-----------------------------------------------------------
+void main(void){
+    unsigned int loopcounter,function_board_cmd,printer_board_reply;
+    unsigned char state = 0;
+    unsigned char wwKey,ch;
+    unsigned char lastsec = 0;
+
+    // from the data sheet:
+    // "After power-up, all PWM-related I/O ports on the IAP15W4K61S4 are in high impedance state.
+    // These ports need to be set to quasi-bidirectional or strong push-pull mode for normal use."
+    // Affected ports: P0.6,P0.7,P1.6,P1.7,P2.1,P2.2,P2.3,P2.7,P3.7,P4.2,P4.4,P4.5
+    P0M1 = 0;                                               // set P0 to quasi-bidirectional
+    P0M0 = 0;
+
+    // interrupt priorities. the UART3 and UART4 interrupts are fixed at low priority on the STC15
+    // series, so every other interrupt is kept at low priority too: a high priority ISR could hold
+    // off a Function Board or Printer Board word for longer than the 58.7 microseconds before the
+    // next word overwrites it. with a single priority level no ISR can interrupt another, so the
+    // UART2, UART3 and UART4 ISRs can safely share register bank 3.
+    IP = 0;                                                 // UART1, Timer 0 and the rest low priority
+    IP2 = 0;                                                // UART2 and the rest low priority
+    timebase_init();                                        // Timer 0 free running, 1 microsecond time stamps
+    uart1_init(115200);                                     // initialize UART1 for N-8-1 at 115200bps for debug/monitor
+    hostBaudRate = (get_setting(EE_HOSTBAUD) == 1) ? 115200 : 9600;// power-on host baud rate saved in EEPROM
+    uart2_init(hostBaudRate);                               // initialize UART2 for N-8-1 at 9600 or 115200bps, RTS-CTS handshaking for host PC
+    uart2_watermarks(get_setting(EE_SPOOLPAUSE),get_setting(EE_SPOOLRESUME));// spool watermarks saved in EEPROM, if any
+    idleFlush = get_setting(EE_IDLEFLUSH);                  // host idle time saved in EEPROM, if any
+    if (idleFlush == 0xFF) idleFlush = IDLEFLUSH;
+    uart3_init();                                           // initialize UART3 for N-9-1 at 187500bps for connection to the Function Board
+    uart4_init();                                           // initialize UART4 for N-9-1 at 187500bps for connection to the Printer Board
+
+    EA = TRUE;                                              // global interrupt enable
+
+    printf("\n%s\n",about);
+    if (POF) {
+        printf ("Power-on reset\n");
+        wdResets = 0;
+        softResetFlag = 0;
+        CLR_POF;
+    }
+
+    else if (WDT_FLAG){
+         printf("%s %d\n","Watch Dog Timer resets:",(int)++wdResets);
+         CLR_WDT_FLAG;
+    }
+
+    else if (softResetFlag == 0x55) {
+        printf ("Software reset\n");
+        softResetFlag = 0;
+    }
+
+    printf("Initializing");
+    lastsec = seconds;
+    ww_init();                                              // initialize ww vars
+    ww_reset(3);                                            // reset both boards                                                    // initialize ww vars and reset both boards
+    WDT_CONTR |= 0x06;                                      // watch dog timer overflows in 4194.3 mS
+    ENABLE_WDT;                                             // run watch dog timer
+
+    //////////// determine the pitch of the printwheel /////////////
+    printWheel = 0;
+    timeout = ONESEC*6;
+    while(!printWheel && timeout) {                         // loop for up to 6 seconds or until the printer board replies to 0x121,0x001...
+        if (lastsec != seconds) {                           // once each second...
+            lastsec = seconds;
+            putchar('.');                                   // dots on screen to monitor progress
+            RESET_WDT;                                      // reset watch dog timer every second
+        }
+
+        if (function_board_cmd_avail()){                    // if there's a command from the function board...
+            function_board_cmd = get_function_board_cmd();  // retrieve the command from UART3
+            send_to_printer_board(function_board_cmd);      // relay the command to the printer board
+            switch(state) {
+                case 0:
+                    if (function_board_cmd == 0x121) state = 1;
+                    break;
+                case 1:
+                    if (function_board_cmd == 0x001) state = 2;
+                    else state = 0;                         // 0x121,0x001 is the "reset" command  from the function board
+            }
+        }
+
+        if (printer_board_reply_avail()) {                  // if there's a reply from the Printer Board...
+            printer_board_reply = get_printer_board_reply();// retrieve the reply from UART4
+            send_to_function_board(printer_board_reply);    // relay replies from the Printer Board to the Function Board
+            if (state == 2) {                               // if the reset command has been sent, the reply from the printer board is the printwheel pitch
+               printWheel = printer_board_reply;            // we now know the pitch of the printwheel, exit the loop
+               switch(printWheel) {
+                  case 0x008:
+                     printf("\nPS printwheel\n");
+                     tabStop = 5;                           // tab stops every 5 characters (every 1/2 inch)
+                     uSpacesPerChar = 10;                   // 10 micro spaces/character
+                     uLinesPerLine = 16;                    // 16 micro lines/full line
+                     break;
+                  case 0x010:
+                     printf("\n15P printwheel\n");
+                     tabStop = 7;                           // tab stops every 7 characters (every 1/2 inch)
+                     uSpacesPerChar = 8;
+                     uLinesPerLine = 12;
+                     break;
+                  case 0x020:
+                     printf("\n12P printwheel\n");
+                     tabStop = 6;                           // tab stops every 6 characters (every 1/2 inch)
+                     uSpacesPerChar = 10;                   // 10 micro spaces/character
+                     uLinesPerLine = 16;                    // 16 micro lines/full line
+                     break;
+                  case 0x021:
+                     printf("\nNo printwheel\n");
+                     tabStop = 6;                           // tab stops every 6 characters (every 1/2 inch)
+                     uSpacesPerChar = 10;                   // 10 micro spaces/character
+                     uLinesPerLine = 16;                    // 16 micro lines/full line
+                     break;
+                  case 0x040:
+                     printf("\n10P printwheel\n");
+                     tabStop = 5;                           // tab stops every 5 characters (every 1/2 inch)
+                     uSpacesPerChar = 12;                   // 10 micro spaces/character
+                     uLinesPerLine = 16;                    // 16 micro lines/full line
+                     break;
+                  default:
+                     printf("\nUnable to determine printwheel. Defaulting to 12P.\n");
+                     printf("0x%02X\n",(int)printWheel);
+                     tabStop = 6;                           // tab stops every 6 characters (every 1/2 inch)
+                     uSpacesPerChar = 10;                   // 10 micro spaces/character
+                     uLinesPerLine = 16;                    // 16 micro lines/full line
+                     errorLED=TRUE;
+               } // switch(printWheel)
+            } // if (state == 2)
+        } // if (printer_board_reply_avail())
+    } // while(!printWheel)
+
+    if (!timeout)                                           // turn on error light if unable to determine printwheel
+       errorLED = TRUE;
+       
+    //////////// relay the remaining initialization commands from Function to Printer board /////////////
+    timeout = ONESEC;                                       // empirically determined 1 second is adequate
+    while(timeout) {                                        // loop for one second
+        RESET_WDT;                                          // reset watch dog timer
+
+        if (function_board_cmd_avail()){                    // if there's a command from the function board...
+            function_board_cmd = get_function_board_cmd();
+            //printf("%03X\n",function_board_cmd);
+            send_to_printer_board(function_board_cmd);      // relay the command to the printer board
+        }
+
+        if (printer_board_reply_avail()) {                  // if there's a reply from the Printer Board...
+            printer_board_reply = get_printer_board_reply();
+            //printf("%03X\n",printer_board_reply);
+            send_to_function_board(printer_board_reply);    // relay replies from the Printer Board to the Function Board
+        }
+    }
+
+    function_board_ack(TRUE);                               // from now on the UART3 ISR acknowledges the Function Board
+    printf("<ESC> H for help\n");
+    printf("Ready\n");
+    initializing = FALSE;
+    amberLED = OFF;                                         // turn off the amber LED
+    greenLED = OFF;                                         // turn off the green LED
+    redLED = OFF;                                           // turn off the red LED
+    loopcounter = 0;
+
+    //----------------- loop here forever -----------------------------------------
+    while(TRUE) {
+
+        RESET_WDT;                                              // reset the watch dog timer each pass thru the loop
+
+        if (++loopcounter==0) {                                 // every 65536 passes through the loop (at about 2Hz)
+            greenLED = !greenLED;                               // toggle the green "heart beat" LED
+        }
+
+        latency_poll();                                         // record the host to strike latency of a character once it's struck
+
+        //////////// in passthrough mode, relay commands and replies between the Function and Printer Boards ////////////
+        if (passthrough) {
+            if (function_board_cmd_avail()) {                   // if there's a command from the Function Board...
+                function_board_cmd = get_function_board_cmd();
+                send_to_printer_board(function_board_cmd);      // relay the command to the printer board
+                if (monitor) printf("%03X\n",function_board_cmd);
+                wwKey = ww_decode_keys(function_board_cmd);     // keystrokes are still decoded...
+                if (wwKey && (wwKey != 0xF0) && !localMode)
+                    putchar2(wwKey);                            // and sent to the host in line mode
+            }
+            if (printer_board_reply_avail()) {                  // if there's a reply from the Printer Board...
+                printer_board_reply = get_printer_board_reply();
+                send_to_function_board(printer_board_reply);    // relay it to the Function Board
+            }
+        }
+
+        //////////// check for key press codes coming from the Function Board ////////////
+        else if (function_board_cmd_avail()) {                  // if there's a command from the Function Board...
+            function_board_cmd = get_function_board_cmd();      // retrieve it from UART3, the ISR has already acknowledged it
+            if (monitor) printf("%03X\n",function_board_cmd);   // if the monitor flag is set...
+
+            wwKey = ww_decode_keys(function_board_cmd);         // convert the function board keystroke cmd into ASCII character
+            if (wwKey) {                                        // if it's a valid ASCII key...
+                if (wwKey == 0xF0) {                            // is it Code+Erase key combo?
+                    if (column == 1) {                          // carrier must be at left margin to change modes
+                        localMode = !localMode;                 // toggle the line/local flag
+                        ww_spin();                              // spin the printwheel
+                        ww_paper_up();                          // up 1/2 line, then
+                        ww_flush();
+                        ww_paper_down();                        // down 1/2 line as a visual indication
+                        ww_flush();
+                    }
+                }
+                else {
+                    if (localMode) {
+                       print_char_on_WW(wwKey);                 // if 'local' mode, print the ASCII character on the Wheelwriter
+                       ww_flush();                              // don't leave the keystroke in the line buffer
+                    }
+                    else 
+                       putchar2(wwKey);                         // else print the ASCII character on the console
+                }
+            }
+        }
+
+        //////////// check for characters to print coming from the serial console (UART2)     ////////////
+        if (!passthrough && char_avail2()) {                    // if there is a character in the serial receive buffer (the host waits while in passthrough mode)...
+            ch = getchar2();                                    // retrieve the character from UART2
+            latency_begin();
+            print_char_on_WW(ch);                               // send it to the Wheelwriter for printing
+            latency_end();
+            timeout = idleFlush;                                // restart the host idle timer
+            hostIdle = FALSE;
+        }
+        else if (!timeout && !hostIdle) {                       // if the host has stopped sending for idleFlush ticks...
+            hostIdle = TRUE;
+            if (idleFlush) ww_idle();                           // print any partial line in the line buffer
+        }
+
+        //////////// check for characters to coming from the debug serial connection (UART1) ////////////
+        if (char_avail1()) {
+           ch = getchar1();
+           process_key(ch);
+        }
+    } //----------------- end of loop -----------------------------------------
+}
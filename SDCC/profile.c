@@ -0,0 +1,82 @@
+//************************************************************************//
+// Printer Board latency profile for the Small Device C Compiler (SDCC)   //
+//                                                                        //
+// The UART4 ISR times the wait from the end of each word sent to the     //
+// Printer Board to its acknowledge. The wait for the last word of a      //
+// command is the time the Printer Board takes to carry it out, so it's   //
+// added to a histogram for that kind of command: strikes, correction     //
+// tape strikes, paper movement, spins and carrier movement in three      //
+// bands of distance. The histograms are kept in internal MOVX SRAM and   //
+// dumped over UART1, showing where the mechanical time of a job goes.    //
+//************************************************************************//
+
+#include <stdio.h>
+#include "reg51.h"
+#include "stc51.h"
+#include "profile.h"
+
+unsigned char __xdata profileState = 0;     // position in the command being sent
+unsigned char __xdata profileOp;            // opcode of the command being sent
+unsigned char __xdata profileData;          // first data word of the command being sent
+unsigned char __xdata profileKind = PROFILE_NONE; // PROFILE_NONE or the kind of command the last word sent finished
+unsigned long __xdata profileWait;          // used by PROFILE_ACKED()
+volatile unsigned int __xdata profile_hist[PROFILEKINDS][PROFILEBINS];  // acknowledge waits of each kind of command
+volatile unsigned long __xdata profile_total[PROFILEKINDS];             // sum of the waits in microseconds
+
+const char * __code profileName[PROFILEKINDS] = {"strike","erase","vertical","horiz <=24","horiz <=240","horiz >240","spin"};
+const char * __code profileBinName[PROFILEBINS] = {"<1","<2","<4","<8","<16","<33","<66","<131","<262",">=262"};
+
+//-----------------------------------------------------------
+// empties the histograms
+//-----------------------------------------------------------
+void profile_clear(void) {
+    unsigned char k,b;
+
+    CLR_ES4;
+    for(k=0; k<PROFILEKINDS; k++) {
+        for(b=0; b<PROFILEBINS; b++)
+            profile_hist[k][b] = 0;
+        profile_total[k] = 0;
+    }
+    SET_ES4;
+}
+
+//-----------------------------------------------------------
+// dumps the histograms over UART1, then empties them. the
+// dump starts with a line containing 'PROFILE' and a line
+// of column headings, then one line per kind of command:
+// its name, the number of commands, the total time in
+// milliseconds and the number of commands acknowledged
+// within each bin, headed with the upper limit of the bin
+// in milliseconds. the dump ends with a line containing
+// only a period.
+//-----------------------------------------------------------
+void profile_dump(void) {
+    unsigned char k,b;
+    unsigned int n;
+    unsigned long count,total;
+
+    printf("\nPROFILE\n");
+    printf("%-11s %6s %9s","command","count","total ms");
+    for(b=0; b<PROFILEBINS; b++)
+        printf(" %5s",profileBinName[b]);
+    printf("\n");
+    for(k=0; k<PROFILEKINDS; k++) {
+        CLR_ES4;                                    // the ISR updates the histograms
+        total = profile_total[k];
+        count = 0;
+        for(b=0; b<PROFILEBINS; b++)
+            count += profile_hist[k][b];
+        SET_ES4;
+        printf("%-11s %6lu %9lu",profileName[k],count,total/1000);
+        for(b=0; b<PROFILEBINS; b++) {
+            CLR_ES4;
+            n = profile_hist[k][b];
+            SET_ES4;
+            printf(" %5u",n);
+        }
+        printf("\n");
+    }
+    printf(".\n");
+    profile_clear();
+}
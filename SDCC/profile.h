@@ -0,0 +1,100 @@
+// for the Small Device C Compiler (SDCC)
+
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#define PROFILEBINS 10                  // bin 0: less than 1 ms, bin n: 512<<n to 1024<<n us, bin 9: 262 ms or more
+
+// the kinds of Printer Board command profiled
+#define PROFILE_STRIKE  0               // 0x121,0x003,code,advance: strike and advance the carrier
+#define PROFILE_ERASE   1               // 0x121,0x004,code,n: strike on the correction tape
+#define PROFILE_VERT    2               // 0x121,0x005,data: paper movement
+#define PROFILE_HSHORT  3               // 0x121,0x006,high,low or a space: carrier movement up to HSHORT micro spaces
+#define PROFILE_HMEDIUM 4               // carrier movement up to HMEDIUM micro spaces
+#define PROFILE_HLONG   5               // carrier movement longer than HMEDIUM micro spaces
+#define PROFILE_SPIN    6               // 0x121,0x007: printwheel spin
+#define PROFILEKINDS    7
+#define PROFILE_NONE    0xFF            // the word sent doesn't finish a profiled command
+
+#define HSHORT  24                      // two characters at 10 pitch
+#define HMEDIUM 240                     // two inches
+
+extern unsigned char __xdata profileState;  // position in the command being sent
+extern unsigned char __xdata profileOp;     // opcode of the command being sent
+extern unsigned char __xdata profileData;   // first data word of the command being sent
+extern unsigned char __xdata profileKind;   // PROFILE_NONE or the kind of command the last word sent finished
+extern unsigned long __xdata profileWait;   // used by PROFILE_ACKED()
+extern volatile unsigned int __xdata profile_hist[PROFILEKINDS][PROFILEBINS];
+extern volatile unsigned long __xdata profile_total[PROFILEKINDS];
+
+// ---------------------------------------------------------------------------
+// follows the commands sent to the Printer Board one word at a time. sets
+// profileKind to the kind of command when 'word' is the last word of a
+// command that is profiled, otherwise to PROFILE_NONE. a macro rather than a
+// function so that it can be used in the UART4 ISR.
+// ---------------------------------------------------------------------------
+#define PROFILE_SENT(word)                                                     \
+    profileKind = PROFILE_NONE;                                                \
+    if ((word) == 0x121)                  /* every command starts with 0x121 */\
+        profileState = 1;                                                      \
+    else if (profileState == 1) {         /* the opcode                      */\
+        profileOp = (word);                                                    \
+        profileState = 2;                                                      \
+        if (profileOp == 0x07) {                                               \
+            profileKind = PROFILE_SPIN;                                        \
+            profileState = 0;                                                  \
+        }                                                                      \
+        else if ((profileOp < 0x03) || (profileOp > 0x06))                     \
+            profileState = 0;             /* not profiled                    */\
+    }                                                                          \
+    else if (profileState == 2) {         /* the first data word             */\
+        profileData = (word);                                                  \
+        profileState = 3;                                                      \
+        if (profileOp == 0x05) {                                               \
+            profileKind = PROFILE_VERT;                                        \
+            profileState = 0;                                                  \
+        }                                                                      \
+    }                                                                          \
+    else if (profileState == 3) {         /* the second data word, the last  */\
+        unsigned int distance;                                                 \
+        profileState = 0;                                                      \
+        if (profileOp == 0x04)                                                 \
+            profileKind = PROFILE_ERASE;                                       \
+        else if ((profileOp == 0x03) && profileData)                           \
+            profileKind = PROFILE_STRIKE;                                      \
+        else {                            /* a space or a carrier movement   */\
+            distance = (word) & 0xFF;                                          \
+            if (profileOp == 0x06)                                             \
+                distance |= (unsigned int)(profileData & 0x07)<<8;             \
+            if (distance <= HSHORT) profileKind = PROFILE_HSHORT;              \
+            else if (distance <= HMEDIUM) profileKind = PROFILE_HMEDIUM;       \
+            else profileKind = PROFILE_HLONG;                                  \
+        }                                                                      \
+    }
+
+// ---------------------------------------------------------------------------
+// adds the acknowledge wait 'usec' of the last word sent to the histogram of
+// its kind of command, if that word finished a command that is profiled. the
+// bins are a log scale, each twice as wide as the one before, so that the
+// bin number is found with shifts rather than a library divide. the counts
+// stop at 65535 rather than wrapping. a macro rather than a function so that
+// it can be used in the UART4 ISR.
+// ---------------------------------------------------------------------------
+#define PROFILE_ACKED(usec)                                                    \
+    if (profileKind != PROFILE_NONE) {                                         \
+        unsigned char bin = 0;                                                 \
+        profileWait = (usec)>>10;                                              \
+        while (profileWait && (bin < PROFILEBINS-1)) {                         \
+            profileWait >>= 1;                                                 \
+            ++bin;                                                             \
+        }                                                                      \
+        if (profile_hist[profileKind][bin] != 0xFFFF)                          \
+            ++profile_hist[profileKind][bin];                                  \
+        profile_total[profileKind] += (usec);                                  \
+        profileKind = PROFILE_NONE;                                            \
+    }
+
+void profile_clear(void);
+void profile_dump(void);
+
+#endif
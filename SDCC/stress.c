@@ -0,0 +1,126 @@
+//************************************************************************//
+// Interrupt stress test for the Small Device C Compiler (SDCC)           //
+//                                                                        //
+// Keeps all four UARTs busy at once: UART1 sends the same monitor line   //
+// over and over, a character whenever its transmit buffer has room, text //
+// sent by the host on UART2 is printed as fast as the host sends it (so  //
+// the Printer Board bus is busy), and keystrokes from the Function Board //
+// are read as they arrive. The Function Board and Printer Board words    //
+// must each be read within one word time (58.7 us at 187500bps) or       //
+// they're lost. When a key is pressed on UART1 the test stops and        //
+// reports the words sent and received on the two buses and any that      //
+// were lost: words dropped because a receive buffer was full and words   //
+// sent to the Printer Board whose acknowledge never arrived, and how     //
+// often a queued word had to wait for the Printer Board bus to go high.  //
+//************************************************************************//
+
+#include <stdio.h>
+#include "reg51.h"
+#include "stc51.h"
+#include "control.h"
+#include "uart1.h"
+#include "uart2.h"
+#include "ww-uart3.h"
+#include "ww-uart4.h"
+#include "timebase.h"
+#include "wheelwriter.h"
+#include "diablo.h"
+#include "stress.h"
+
+#define FALSE 0
+#define TRUE  1
+
+#define STALLUSEC 2000000UL             // longest the Printer Board takes to acknowledge a word
+
+__code char monitorLine[] = "stress test running, press any key to stop\n"; // sent over and over to keep UART1 busy
+
+//-----------------------------------------------------------
+// returns FALSE if the Printer Board is waiting for words
+// but hasn't acknowledged one for STALLUSEC microseconds.
+// 'acks' and 'since' hold the acknowledge count and the time
+// it last changed between calls.
+//-----------------------------------------------------------
+unsigned char stress_acking(unsigned long *acks,unsigned long *since) {
+    unsigned long count;
+
+    CLR_ES4;                                            // the UART4 ISR counts the acknowledges
+    count = ack4_count;
+    SET_ES4;
+    if (!printer_board_busy() || (count != *acks)) {
+        *acks = count;
+        *since = timestamp();
+        return TRUE;
+    }
+    return (timestamp()-*since) < STALLUSEC;
+}
+
+//-----------------------------------------------------------
+// runs the stress test until a key is pressed on UART1, then
+// prints the results. a lost acknowledge stops the Printer
+// Board command queue, so the test stops on its own if the
+// Printer Board stops acknowledging. if the queue was full
+// at the time, the loop can't get back to check it and the
+// watchdog resets the MCU instead (<ESC><^Z><w> shows it).
+//-----------------------------------------------------------
+void stress_run(void) {
+    unsigned long start,elapsed,since,hostBytes = 0,fbWords = 0,acks,lost;
+    unsigned int overruns3,overruns4,busStalls;
+    unsigned char stalled = FALSE,monitor = 0;
+
+    ww_flush();
+    while (printer_board_busy()) RESET_WDT;
+    printf("\nSTRESS send text from the host, press any key here to stop\n");
+    CLR_ES3;
+    overruns3 = rx3_overruns;
+    SET_ES3;
+    CLR_ES4;
+    overruns4 = rx4_overruns;
+    busStalls = bus4_stalls;
+    SET_ES4;
+    ack_timing(TRUE);                                   // count the words sent and acknowledged
+    acks = 0;
+    start = since = timestamp();
+
+    while (!char_avail1() && !stalled) {
+        RESET_WDT;
+        if (tx_room1()) {                               // keeps UART1 sending without waiting for it
+            putchar1(monitorLine[monitor++]);
+            if (!monitorLine[monitor]) monitor = 0;
+        }
+        if (char_avail2()) {
+            print_char_on_WW(getchar2());
+            ++hostBytes;
+        }
+        while (function_board_cmd_avail()) {
+            get_function_board_cmd();
+            ++fbWords;
+        }
+        stalled = !stress_acking(&acks,&since);
+    }
+    if (char_avail1()) getchar1();                      // the key that stopped the test
+
+    ww_flush();                                         // let the Printer Board finish
+    while (!stalled && printer_board_busy()) {
+        RESET_WDT;
+        stalled = !stress_acking(&acks,&since);
+    }
+    elapsed = timestamp()-start;
+    ack_timing(FALSE);
+
+    CLR_ES3;
+    overruns3 = rx3_overruns-overruns3;
+    SET_ES3;
+    CLR_ES4;
+    overruns4 = rx4_overruns-overruns4;
+    busStalls = bus4_stalls-busStalls;
+    acks = ack4_count;
+    SET_ES4;
+    lost = overruns3+overruns4+(words4-acks);
+    printf("\nSTRESS %lu ms\n",elapsed/1000);
+    printf("host bytes printed:     %lu\n",hostBytes);
+    printf("Function Board words:   %lu received, %u lost\n",fbWords,overruns3);
+    printf("Printer Board words:    %lu sent, %lu acknowledged, %u replies lost\n",words4,acks,overruns4);
+    printf("Printer Board bus:      held low %u times\n",busStalls);
+    printf("lost words:             %lu%s\n",lost,stalled ? ", the Printer Board stopped acknowledging" : "");
+    printf(".\n");
+}
@@ -0,0 +1,8 @@
+// for the Small Device C Compiler (SDCC)
+
+#ifndef __STRESS_H__
+#define __STRESS_H__
+
+void stress_run(void);
+
+#endif
@@ -0,0 +1,47 @@
+//************************************************************************//
+// Time base for the Small Device C Compiler (SDCC)                       //
+//                                                                        //
+// Timer 0 runs free as a 16 bit timer clocked at 1 MHz (SYSclk/12). Its  //
+// overflows, every 65.536 milliseconds, are counted by the Timer 0 ISR   //
+// in main.c, which makes a 32 bit time stamp with 1 microsecond          //
+// resolution that wraps after about 71 minutes. The 50 millisecond       //
+// timeouts and the uptime are derived from the same overflows.           //
+//************************************************************************//
+
+#include "reg51.h"
+#include "stc51.h"
+#include "timebase.h"
+
+volatile unsigned int timeHigh = 0;     // Timer 0 overflows, the upper 16 bits of the time stamp
+
+//-----------------------------------------------------------
+// starts Timer 0 counting from zero in mode 0 (16 bit auto-
+// reload, with a reload value of zero it runs free) and
+// enables its interrupt.
+//-----------------------------------------------------------
+void timebase_init(void) {
+    TR0 = 0;
+    TMOD &= 0xF0;                       // timer 0 mode 0: 16-bit auto-reload timer
+    CLR_T0x12;                          // SYSclk/12, 1 microsecond per count
+    TL0 = 0;                            // reload value and count
+    TH0 = 0;
+    timeHigh = 0;
+    TF0 = 0;
+    ET0 = 1;                            // enable timer 0 interrupt
+    TR0 = 1;                            // run timer 0
+}
+
+//-----------------------------------------------------------
+// returns the 32 bit time stamp in microseconds since reset.
+// interrupts are disabled while it's read.
+//-----------------------------------------------------------
+unsigned long timestamp(void) {
+    unsigned long t;
+    __bit ea;
+
+    ea = EA;
+    EA = 0;
+    TIMESTAMP(t);
+    EA = ea;
+    return t;
+}
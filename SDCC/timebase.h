@@ -0,0 +1,31 @@
+// for the Small Device C Compiler (SDCC)
+
+#ifndef __TIMEBASE_H__
+#define __TIMEBASE_H__
+
+extern volatile unsigned int timeHigh;  // Timer 0 overflows, the upper 16 bits of the time stamp
+
+// ---------------------------------------------------------------------------
+// reads the 32 bit time stamp, in microseconds since reset, into 't'. Timer 0
+// runs free at 1 microsecond per count and supplies the lower 16 bits; the
+// Timer 0 ISR counts the overflows in timeHigh. a macro rather than a
+// function so that it can be used in the ISRs, where it's atomic as long as
+// the Timer 0 ISR can't interrupt. an overflow that the Timer 0 ISR hasn't
+// counted yet is still pending in TF0 and is added here. use timestamp() in
+// the main loop.
+// ---------------------------------------------------------------------------
+#define TIMESTAMP(t)                                                           \
+    {                                                                          \
+        unsigned char tsHi,tsLo;                                               \
+        do {                                                                   \
+            tsHi = TH0;                                                        \
+            tsLo = TL0;                                                        \
+        } while (tsHi != TH0);                                                 \
+        t = ((unsigned long)timeHigh<<16)|((unsigned int)tsHi<<8)|tsLo;        \
+        if (TF0 && !(tsHi & 0x80)) t += 0x10000;                               \
+    }
+
+void timebase_init(void);
+unsigned long timestamp(void);
+
+#endif
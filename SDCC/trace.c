@@ -0,0 +1,102 @@
+//************************************************************************//
+// Bus trace for the Small Device C Compiler (SDCC)                       //
+//                                                                        //
+// Records the words on the Function Board (UART3) and Printer Board      //
+// (UART4) buses with their direction and a time stamp in a ring buffer   //
+// in internal MOVX SRAM. Unlike monitor mode, which prints each word as  //
+// it's received, recording a word takes only a few microseconds. Each    //
+// entry keeps the time since the one before in 16 bits, so the 1 KB ring //
+// holds the last 256 words recorded, about 30 characters of printing.    //
+// It's dumped over UART1, with the time stamps rebuilt, once the trace   //
+// has been stopped.                                                      //
+//************************************************************************//
+
+#include <stdio.h>
+#include "reg51.h"
+#include "stc51.h"
+#include "trace.h"
+
+#define FALSE 0
+#define TRUE  1
+
+#if TRACESIZE < 16
+    #error TRACESIZE may not be less than 16.
+#elif TRACESIZE > 256
+    #error TRACESIZE may not be greater than 256.
+#elif ((TRACESIZE & (TRACESIZE-1)) != 0)
+    #error TRACESIZE must be a power of 2.
+#endif
+
+volatile __bit traceArmed = FALSE;      // words are recorded while set
+__bit traceEA;                          // EA saved by TRACE()
+volatile unsigned char trace_head;      // index of the next entry to be written
+volatile unsigned int trace_total;      // number of words recorded since the trace was armed
+volatile unsigned int __xdata trace_word[TRACESIZE];  // bits 0-8: word, bits 12-13: source, bit 14: TRACE_COARSE
+volatile unsigned int __xdata trace_time[TRACESIZE];  // time since the previous entry, in microseconds or 64 microseconds
+unsigned long __xdata traceLast;        // time stamp of the last entry recorded
+unsigned long __xdata traceGap;         // used by TRACE()
+
+//-----------------------------------------------------------
+// when 'on' is TRUE, empties the trace buffer and starts
+// recording. when FALSE, stops recording.
+//-----------------------------------------------------------
+void trace_arm(unsigned char on) {
+    EA = 0;
+    if (on) {
+        trace_head = 0;
+        trace_total = 0;
+        TIMESTAMP(traceLast);
+    }
+    traceArmed = on;
+    EA = 1;
+}
+
+//-----------------------------------------------------------
+// returns the time in microseconds between entry 'i' and the
+// entry before it
+//-----------------------------------------------------------
+unsigned long trace_gap(unsigned char i) {
+    if (trace_word[i] & TRACE_COARSE) return (unsigned long)trace_time[i]<<6;
+    return trace_time[i];
+}
+
+//-----------------------------------------------------------
+// stops recording and dumps the trace buffer over UART1,
+// oldest entry first. the dump starts with a line giving the
+// number of entries and the number of words recorded, then
+// one line per entry:
+//    S WWW TTTTTTTT
+// S is the source (TRACE_FB, TRACE_PB, TRACE_TOPB or
+// TRACE_TOFB), WWW is the 9 bit word and TTTTTTTT is the time
+// stamp in microseconds, all in hex. the time stamps are
+// worked back from the last entry's, so they're exact except
+// that a gap of more than 65.5 ms is rounded to 64 us and one
+// of more than 4.2 s is cut to 4.2 s, which moves every entry
+// before it later. the dump ends with a line containing only
+// a period.
+//-----------------------------------------------------------
+void trace_dump(void) {
+    unsigned char i,first;
+    unsigned int n,count;
+    unsigned int word;
+    unsigned long t;
+
+    trace_arm(FALSE);
+    count = (trace_total < TRACESIZE) ? trace_total : TRACESIZE;
+    printf("\nTRACE %u %u\n",count,trace_total);
+    first = (unsigned char)(trace_head-count) & (TRACESIZE-1);
+    t = traceLast;
+    i = first;
+    for(n=1; n<count; n++) {                    // back to the time of the oldest entry
+        i = (i+1) & (TRACESIZE-1);
+        t -= trace_gap(i);
+    }
+    i = first;
+    for(n=0; n<count; n++) {
+        word = trace_word[i];
+        if (n) t += trace_gap(i);
+        printf("%u %03X %08lX\n",(word>>12)&0x03,word&0x1FF,t);
+        i = (i+1) & (TRACESIZE-1);
+    }
+    printf(".\n");
+}
@@ -0,0 +1,57 @@
+// for the Small Device C Compiler (SDCC)
+
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#include "timebase.h"
+
+#define TRACESIZE 256                   // must be 256, 128, 64, 32 or 16 entries
+#define TRACE_COARSE 0x4000             // set in an entry whose time is in units of 64 microseconds
+
+// where each traced word came from
+#define TRACE_FB   0                    // received from the Function Board
+#define TRACE_PB   1                    // received from the Printer Board
+#define TRACE_TOPB 2                    // sent to the Printer Board
+#define TRACE_TOFB 3                    // sent to the Function Board
+
+extern volatile __bit traceArmed;
+extern __bit traceEA;
+extern volatile unsigned char trace_head;
+extern volatile unsigned int trace_total;
+extern volatile unsigned int __xdata trace_word[TRACESIZE];
+extern volatile unsigned int __xdata trace_time[TRACESIZE];
+extern unsigned long __xdata traceLast;
+extern unsigned long __xdata traceGap;
+
+// ---------------------------------------------------------------------------
+// records a 9 bit bus word with its source and the time since the previous
+// entry in the trace buffer when the trace is armed. a macro rather than a
+// function so that it can be used in the UART ISRs. the time is taken from
+// the 32 bit microsecond time stamp in timebase.h and kept in 16 bits: in
+// microseconds up to 65.5 ms, in units of 64 microseconds (TRACE_COARSE) up
+// to 4.2 s, longer gaps are cut to 4.2 s. interrupts are disabled while the
+// entry is written.
+// ---------------------------------------------------------------------------
+#define TRACE(source,word)                                                     \
+    if (traceArmed) {                                                          \
+        traceEA = EA;                                                          \
+        EA = 0;                                                                \
+        TIMESTAMP(traceGap);                                                   \
+        traceGap -= traceLast;                                                 \
+        traceLast += traceGap;                                                 \
+        trace_word[trace_head] = ((word)&0x1FF)|((source)<<12);                \
+        if (traceGap > 0xFFFF) {                                               \
+            traceGap = (traceGap+32)>>6;                                       \
+            if (traceGap > 0xFFFF) traceGap = 0xFFFF;                          \
+            trace_word[trace_head] |= TRACE_COARSE;                            \
+        }                                                                      \
+        trace_time[trace_head] = traceGap;                                     \
+        trace_head = (trace_head+1) & (TRACESIZE-1);                           \
+        ++trace_total;                                                         \
+        EA = traceEA;                                                          \
+    }
+
+void trace_arm(unsigned char on);
+void trace_dump(void);
+
+#endif
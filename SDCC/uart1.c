@@ -1,110 +1,184 @@
-//************************************************************************//
-// Interrupt driven UART1 functions.                                      //
-// for the Small Device C Compiler (SDCC)                                 //
-//                                                                        //
-// UART1 uses a receive buffer in internal MOVX SRAM.                     //
-// UART1 uses the Timer 1 for baud rate generation. init_uart1 must be    //
-// called before using functions. No syntax error handling.               //
-// RxD on pin 21, TxD on pin 22, No handshaking.                          //
-//************************************************************************//
-
-#include "reg51.h"
-#include "stc51.h"
-
-#define FALSE 0
-#define TRUE  1
-#define FOSC 12000000L                          // 12 MHz system clock frequency
-#define RBUFSIZE1 128                           // receive buffer size
-
-#if RBUFSIZE1 < 32
-    #error RBUFSIZE1 may not be less than 32.
-#elif RBUFSIZE1 > 256
-    #error RBUFSIZE1 may not be greater than 256.
-#elif ((RBUFSIZE1 & (RBUFSIZE1-1)) != 0)
-    #error RBUFSIZE1 must be a power of 2.
-#endif
-
-volatile unsigned char rx1_head;                // receive interrupt index for UART1
-volatile unsigned char rx1_tail;                // receive read index for UART1
-volatile unsigned char __xdata rx1_buf[RBUFSIZE1];// receive buffer for UART1 in internal MOVX RAM
-volatile __bit tx1_ready;
-
-// ---------------------------------------------------------------------------
-// UART1 interrupt service routine
-// ---------------------------------------------------------------------------
-void uart1_isr(void) __interrupt(4) __using(2) {
-
-   // uart1 transmit interrupt
-   if (TI) {                                    // transmit interrupt?
-      TI = FALSE;                               // clear transmit interrupt flag
-      tx1_ready = TRUE;                         // transmit buffer is ready for a new character
-    }
-
-    // uart1 receive interrupt
-    if(RI) {                                    // receive character?
-        RI = 0;                                 // clear serial receive interrupt flag
-        rx1_buf[rx1_head] = SBUF;               // Get character from serial port and put into UART1 fifo.
-      if (++rx1_head == RBUFSIZE1) rx1_head = 0;// wrap pointer around to the beginning
-    }
-}
-
-// ---------------------------------------------------------------------------
-//  Initialize UART1 for mode 1 using timer 1 mode 0 for baud rate generation
-// ---------------------------------------------------------------------------
-void uart1_init(unsigned long baudrate) {
-    rx1_head = 0;                               // initialize UART1 buffer head/tail pointers
-    rx1_tail = 0;
-    tx1_ready = TRUE;
-
-    AUXR = 0x40;                                // T1 in 1T mode
-    TMOD = 0x00;                                // T1 in mode 0 (16-bit auto-relaod timer/counter)
-    TL1 = (65536-(FOSC/4/baudrate));            // low byte of preload
-    TH1 = (65536-(FOSC/4/baudrate))>>8;         // high byte of preload
-    TR1 = 1;                                    // run Timer 1
-
-    SCON = 0x50;                                // UART1 Mode 1: 8-bit UART, variable baud-rate
-    REN = TRUE;                                 // enable receive characters.
-    TI = TRUE;                                  // set TI of SCON to Get Ready to Send
-    RI  = FALSE;                                // clear RI of SCON to Get Ready to Receive
-    ES = TRUE;                                  // enable serial interrupt.
-    EA = TRUE;                                  // enable global interrupt
-}
-
-// ---------------------------------------------------------------------------
-// returns 1 if there are character waiting in the UART1 receive buffer
-// ---------------------------------------------------------------------------
-char char_avail1(void) {
-   return (rx1_head != rx1_tail);
-}
-
-//-----------------------------------------------------------
-// waits until a character is available in the UART1 receive
-// buffer. returns the character. does not echo the character.
-//-----------------------------------------------------------
-char getchar1(void) {
-    unsigned char buf;
-
-    while (rx1_head == rx1_tail);               // wait until a character is available
-    buf = rx1_buf[rx1_tail];
-   if (++rx1_tail == RBUFSIZE1) rx1_tail = 0;
-    return(buf);
-}
-
-// ---------------------------------------------------------------------------
-// output one character from UART1. waits until ready to transmit.
-// ---------------------------------------------------------------------------
-char putchar1(char c)  {
-    while (!tx1_ready);                         // wait until ready to transmit
-    SBUF = c;
-    tx1_ready = 0;
-    return (c);
-}
-
-// ---------------------------------------------------------------------------
-// output a string from UART1
-// ---------------------------------------------------------------------------
-void puts1(char *s) {
-    while (s && *s)
-        putchar1 (*s++);
-}
-
+//************************************************************************//
+// Interrupt driven UART1 functions.                                      //
+// for the Small Device C Compiler (SDCC)                                 //
+//                                                                        //
+// UART1 uses receive and transmit buffers in internal MOVX SRAM. the    //
+// transmit buffer is emptied by the ISR so that printf only waits when  //
+// the buffer is full.                                                    //
+// UART1 uses the Timer 1 for baud rate generation. init_uart1 must be    //
+// called before using functions. No syntax error handling.               //
+// RxD on pin 21, TxD on pin 22, No handshaking.                          //
+//************************************************************************//
+
+#include <stdio.h>
+#include "reg51.h"
+#include "stc51.h"
+
+#define FALSE 0
+#define TRUE  1
+#define FOSC 12000000L                          // 12 MHz system clock frequency
+#define RBUFSIZE1 128                           // receive buffer size
+#define TBUFSIZE1 128                           // transmit buffer size
+
+#if RBUFSIZE1 < 32
+    #error RBUFSIZE1 may not be less than 32.
+#elif RBUFSIZE1 > 256
+    #error RBUFSIZE1 may not be greater than 256.
+#elif ((RBUFSIZE1 & (RBUFSIZE1-1)) != 0)
+    #error RBUFSIZE1 must be a power of 2.
+#endif
+
+#if TBUFSIZE1 < 32
+    #error TBUFSIZE1 may not be less than 32.
+#elif TBUFSIZE1 > 128
+    #error TBUFSIZE1 may not be greater than 128.
+#elif ((TBUFSIZE1 & (TBUFSIZE1-1)) != 0)
+    #error TBUFSIZE1 must be a power of 2.
+#endif
+
+volatile unsigned char rx1_head;                // receive interrupt index for UART1
+volatile unsigned char rx1_tail;                // receive read index for UART1
+volatile unsigned char __xdata rx1_buf[RBUFSIZE1];// receive buffer for UART1 in internal MOVX RAM
+volatile unsigned char tx1_head;                // transmit buffer fill index for UART1
+volatile unsigned char tx1_tail;                // transmit interrupt index for UART1
+volatile unsigned char __xdata tx1_buf[TBUFSIZE1];// transmit buffer for UART1 in internal MOVX RAM
+volatile __bit tx1_busy;                        // set while the ISR is sending from the transmit buffer
+volatile unsigned int __xdata rx1_overruns;     // characters lost because the receive buffer was full
+volatile unsigned char __xdata rx1_highWater;   // most characters waiting in the receive buffer at once
+volatile unsigned long __xdata rx1_total;       // characters received
+extern __bit errorLED;                          // defined in main.c
+
+// ---------------------------------------------------------------------------
+// UART1 interrupt service routine
+// ---------------------------------------------------------------------------
+void uart1_isr(void) __interrupt(4) __using(2) {
+   unsigned char next;
+
+   // uart1 transmit interrupt
+   if (TI) {                                    // transmit interrupt?
+      TI = FALSE;                               // clear transmit interrupt flag
+      if (tx1_head != tx1_tail)                 // if there's another character in the transmit buffer...
+         SBUF = tx1_buf[tx1_tail++ & (TBUFSIZE1-1)];// send it
+      else
+         tx1_busy = FALSE;                      // else the transmit buffer is empty
+    }
+
+    // uart1 receive interrupt
+    if(RI) {                                    // receive character?
+        RI = 0;                                 // clear serial receive interrupt flag
+        ++rx1_total;
+        next = rx1_head+1;
+        if (next == RBUFSIZE1) next = 0;        // wrap pointer around to the beginning
+        if (next != rx1_tail) {                 // unless the fifo is full...
+            rx1_buf[rx1_head] = SBUF;           // Get character from serial port and put into UART1 fifo.
+            rx1_head = next;
+            next = (rx1_head-rx1_tail) & (RBUFSIZE1-1);// characters now waiting
+            if (next > rx1_highWater) rx1_highWater = next;
+        }
+        else {
+            ++rx1_overruns;                     // the character is lost
+            errorLED = TRUE;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+//  Initialize UART1 for mode 1 using timer 1 mode 0 for baud rate generation
+// ---------------------------------------------------------------------------
+void uart1_init(unsigned long baudrate) {
+    rx1_head = 0;                               // initialize UART1 buffer head/tail pointers
+    rx1_tail = 0;
+    tx1_head = 0;                               // initialize UART1 transmit buffer indexes
+    tx1_tail = 0;
+    tx1_busy = FALSE;
+
+    TR1 = 0;                                    // stop Timer 1 while it's set up
+    SET_T1x12;                                  // T1 in 1T mode
+    CLR_S1ST2;                                  // T1 is the baud rate generator for UART1
+    TMOD &= 0x0F;                               // T1 in mode 0 (16-bit auto-reload timer), Timer 0 is left alone
+    TL1 = (65536-(FOSC/4/baudrate));            // low byte of preload
+    TH1 = (65536-(FOSC/4/baudrate))>>8;         // high byte of preload
+    TR1 = 1;                                    // run Timer 1
+
+    SCON = 0x50;                                // UART1 Mode 1: 8-bit UART, variable baud-rate
+    REN = TRUE;                                 // enable receive characters.
+    TI = FALSE;                                 // clear TI of SCON, nothing is being sent
+    RI  = FALSE;                                // clear RI of SCON to Get Ready to Receive
+    ES = TRUE;                                  // enable serial interrupt.
+    EA = TRUE;                                  // enable global interrupt
+}
+
+// ---------------------------------------------------------------------------
+// returns 1 if there are character waiting in the UART1 receive buffer
+// ---------------------------------------------------------------------------
+char char_avail1(void) {
+   return (rx1_head != rx1_tail);
+}
+
+//-----------------------------------------------------------
+// waits until a character is available in the UART1 receive
+// buffer. returns the character. does not echo the character.
+//-----------------------------------------------------------
+char getchar1(void) {
+    unsigned char buf;
+
+    while (rx1_head == rx1_tail);               // wait until a character is available
+    buf = rx1_buf[rx1_tail];
+   if (++rx1_tail == RBUFSIZE1) rx1_tail = 0;
+    return(buf);
+}
+
+// ---------------------------------------------------------------------------
+// puts one character into the UART1 transmit buffer. waits only if the
+// buffer is full. if the ISR isn't already sending, setting TI starts it.
+// ---------------------------------------------------------------------------
+char putchar1(char c)  {
+    while ((unsigned char)(tx1_head-tx1_tail) == TBUFSIZE1);// wait while the transmit buffer is full
+    tx1_buf[tx1_head & (TBUFSIZE1-1)] = c;
+    ++tx1_head;
+    if (!tx1_busy) {                            // if the ISR has emptied the transmit buffer...
+        tx1_busy = TRUE;
+        TI = TRUE;                              // interrupt to start sending again
+    }
+    return (c);
+}
+
+// ---------------------------------------------------------------------------
+// returns 1 if there's room in the UART1 transmit buffer, so that
+// putchar1() won't wait.
+// ---------------------------------------------------------------------------
+char tx_room1(void) {
+    return ((unsigned char)(tx1_head-tx1_tail) != TBUFSIZE1);
+}
+
+// ---------------------------------------------------------------------------
+// waits until everything in the UART1 transmit buffer has been sent
+// ---------------------------------------------------------------------------
+void flush1(void) {
+    while (tx1_busy);
+}
+
+// ---------------------------------------------------------------------------
+// output a string from UART1
+// ---------------------------------------------------------------------------
+void puts1(char *s) {
+    while (s && *s)
+        putchar1 (*s++);
+}
+
+// ---------------------------------------------------------------------------
+// prints the UART1 receive buffer statistics on one line: the buffer size,
+// the most characters ever waiting, the characters lost and received
+// ---------------------------------------------------------------------------
+void uart1_stats(void) {
+    unsigned int overruns;
+    unsigned char highWater;
+    unsigned long total;
+
+    ES = FALSE;
+    overruns = rx1_overruns;
+    highWater = rx1_highWater;
+    total = rx1_total;
+    ES = TRUE;
+    printf("%-12s %5u %10u %9u %11lu\n","UART1 debug",RBUFSIZE1,(int)highWater,overruns,total);
+}
@@ -1,121 +1,264 @@
-//************************************************************************//
-// Interrupt driven UART2 functions with RTS/CTS handshaking.             //
-// for the Small Device C Compiler (SDCC)                                 //
-//
-// UART2 uses a receive buffer in internal MOVX SRAM.                     //
-// UART2 uses the Timer 2 for baud rate generation. init_uart2 must be    //
-// called before using functions. No syntax error handling.               //
-// RxD2 on pin 9, TxD2 on pin 10, RTS on pin 11, CTS on pin 12            //
-//************************************************************************//
-
-#include "reg51.h"
-#include "stc51.h"
-
-#define FALSE 0
-#define TRUE  1
-#define FOSC 12000000L                             // 12 MHz system clock frequency
-#define RBUFSIZE2 128                              // must be 256,128,64 or 32 bytes
-
-#if RBUFSIZE2 < 32
-    #error RBUFSIZE2 may not be less than 32.
-#elif RBUFSIZE2 > 256
-    #error RBUFSIZE2 may not be greater than 256.
-#elif ((RBUFSIZE2 & (RBUFSIZE2-1)) != 0)
-    #error RBUFSIZE2 must be a power of 2.
-#endif
-
-#define PAUSELEVEL RBUFSIZE2/4                     // pause communications to avoid overflow (RTS = 1) when buffer space < 64 bytes
-#define RESUMELEVEL RBUFSIZE2/2                    // resume communications (RTS = 0) when buffer space > 128 bytes
-
-__sbit __at (0x92) RTS;                            // RTS output on pin 11
-__sbit __at (0x93) CTS;                            // CTS input on pin 12 (not used)
-
-volatile unsigned char rx2_head;                   // index used to fill receive buffer
-volatile unsigned char rx2_tail;                   // index used to empty receive buffer
-volatile unsigned char rx2_remaining;              // receive buffer space remaining
-volatile unsigned char __xdata rx2_buf[RBUFSIZE2]; // receive buffer  in internal MOVX RAM
-volatile __bit tx2_ready;                          // set when ready to transmit
-
-// ---------------------------------------------------------------------------
-// UART2 interrupt service routine
-// ---------------------------------------------------------------------------
-void uart2_isr(void) __interrupt(8) __using(3) {
-
-    // UART2 transmit interrupt
-    if (S2TI) {                                    // is this a transmit interrupt?
-      CLR_S2TI;                                    // clear transmit interrupt flag
-      tx2_ready = TRUE;                            // transmit buffer is ready for a new character
-    }
-
-    // UART2 receive interrupt
-    if(S2RI) {                                     // is this a receive interrupt?
-       CLR_S2RI;                                   // clear receive interrupt flag
-       rx2_buf[rx2_head++ & (RBUFSIZE2-1)] = S2BUF;// get character from serial port and put into serial fifo.
-      --rx2_remaining;                             // space remaining in UART2 buffer decreases
-        if (!RTS){                                 // if communications is not now paused...
-         if (rx2_remaining < PAUSELEVEL) {         // if the remaining buffer space is low...
-               RTS = 1;                            // pause communications when space in UART2 buffer decreases to less than 64 bytes
-            }
-      }
-    }
-}
-
-// ---------------------------------------------------------------------------
-//  Initialize UART2 using timer 2 for baud rate generation
-// ---------------------------------------------------------------------------
-void uart2_init(unsigned long baudrate) {
-    rx2_head = 0;                                  // initialize UART3 buffer head/tail pointers.
-    rx2_tail = 0;
-    rx2_remaining = RBUFSIZE2;
-
-    CLR_T2_CT;                                     // clear T2_C/T to make Timer 2 operate as timer instead of counter
-    SET_T2x12;                                     // set T2x12=1 to make Timer 2 operate in 1T mode.
-    T2L = (65536-(FOSC/4/baudrate));               // low byte of preload
-    T2H = (65536-(FOSC/4/baudrate))>>8;            // high byte of preload
-    SET_T2R;                                       // set T2R to enable Timer 2 to run
-    S2CON = 0x50;                                  // UART2 for mode 1
-
-    SET_S2REN;                                     // set S2REN to enable reception
-    SET_S2TI;                                      // set S2TI to enable transmit
-    CLR_S2RI;                                      // clear S2RI
-    RTS = 0;                                       // clear RTS to allow transmissions from remote console
-    SET_ES2;                                       // set ES2 to enable UART2 serial interrupt
-    EA = TRUE;                                     // enable global interrupt
-}
-
-// ---------------------------------------------------------------------------
-// returns 1 if there is a character waiting in the UART2 receive buffer
-// ---------------------------------------------------------------------------
-char char_avail2(void) {
-   return (rx2_head != rx2_tail);
-}
-
-//-----------------------------------------------------------
-// waits until a character is available in the UART2 receive
-// buffer. returns the character. does not echo the character.
-//-----------------------------------------------------------
-char getchar2(void) {
-    unsigned char buf;
-
-    while (rx2_head == rx2_tail);                  // wait until a character is available
-    buf = rx2_buf[rx2_tail++ &(RBUFSIZE2-1)];
-   ++rx2_remaining;                                // space remaining in buffer increases
-   if (RTS) {                                      // if communications is now paused...
-         if (rx2_remaining > RESUMELEVEL) {
-            RTS = 0;                               // clear RTS to resume communications when space remaining in buffer increases above 128 bytes
-         }
-   }
-    return(buf);
-}
-
-// ---------------------------------------------------------------------------
-// sends one character out UART2. waits until ready to transmit.
-// ---------------------------------------------------------------------------
-char putchar2(char c)  {
-   while (!tx2_ready);                             // wait here for transmit ready
-   S2BUF = c;
-   tx2_ready = 0;
-   return (c);
-}
-
-
+//************************************************************************//
+// Interrupt driven UART2 functions with RTS/CTS handshaking.             //
+// for the Small Device C Compiler (SDCC)                                 //
+//
+// UART2 uses a 1280 byte receive spool in internal MOVX SRAM so that a   //
+// host can send a good part of a page without RTS pausing it every line. //
+// The spool indexes wrap by comparison rather than by masking, so its    //
+// size is whatever xdata is left over, not a power of 2.                 //
+// the transmit buffer, also in MOVX SRAM, is emptied by the ISR.         //
+// UART2 uses the Timer 2 for baud rate generation. init_uart2 must be    //
+// called before using functions. No syntax error handling.               //
+// RxD2 on pin 9, TxD2 on pin 10, RTS on pin 11, CTS on pin 12            //
+//************************************************************************//
+
+#include <stdio.h>
+#include "reg51.h"
+#include "stc51.h"
+#include "timebase.h"
+#include "latency.h"
+
+#define FALSE 0
+#define TRUE  1
+#define FOSC 12000000L                             // 12 MHz system clock frequency
+#define RBUFSIZE2 1280                             // spool size in bytes, what xdata has room for below 0xEF0
+
+#if RBUFSIZE2 < 32
+    #error RBUFSIZE2 may not be less than 32.
+#elif RBUFSIZE2 > 4080
+    #error RBUFSIZE2 may not be greater than 4080.
+#endif
+
+#define LEVELUNIT 16                               // the watermarks are set in units of 16 bytes
+#define PAUSELEVEL 64                              // default: pause communications to avoid overflow (RTS = 1) when spool space < 64 bytes
+#define RESUMELEVEL RBUFSIZE2/2                    // default: resume communications (RTS = 0) when spool space > half the spool
+
+#if PAUSELEVEL >= RESUMELEVEL
+    #error PAUSELEVEL must be less than RESUMELEVEL.
+#endif
+
+#define TBUFSIZE2 64                               // must be 128, 64 or 32 bytes
+#define HOLDUSEC 3000UL                            // after RTS is raised, long enough for two more characters at 9600bps
+#define RATEUSEC 100000UL                          // RTS stays high this long after a baud rate change
+
+#if TBUFSIZE2 < 32
+    #error TBUFSIZE2 may not be less than 32.
+#elif TBUFSIZE2 > 128
+    #error TBUFSIZE2 may not be greater than 128.
+#elif ((TBUFSIZE2 & (TBUFSIZE2-1)) != 0)
+    #error TBUFSIZE2 must be a power of 2.
+#endif
+
+__sbit __at (0x92) RTS;                            // RTS output on pin 11
+__sbit __at (0x93) CTS;                            // CTS input on pin 12 (not used)
+
+volatile unsigned int rx2_head;                    // index used to fill receive spool, 0 to RBUFSIZE2-1
+volatile unsigned int rx2_tail;                    // index used to empty receive spool, 0 to RBUFSIZE2-1
+volatile unsigned int rx2_count;                   // characters waiting in the spool
+volatile unsigned char __xdata rx2_buf[RBUFSIZE2]; // receive spool in internal MOVX RAM
+unsigned int __xdata rx2_pauseLevel;               // RTS = 1 when spool space drops below this many bytes
+unsigned int __xdata rx2_resumeLevel;              // RTS = 0 when spool space rises above this many bytes
+volatile unsigned char tx2_head;                   // index used to fill transmit buffer
+volatile unsigned char tx2_tail;                   // index used to empty transmit buffer
+volatile unsigned char __xdata tx2_buf[TBUFSIZE2]; // transmit buffer in internal MOVX RAM
+volatile __bit tx2_busy;                           // set while the ISR is sending from the transmit buffer
+volatile unsigned int __xdata rx2_overruns;        // characters lost because the spool was full
+volatile unsigned int __xdata rx2_highWater;       // most characters waiting in the spool at once
+volatile unsigned long __xdata rx2_total;          // characters received
+extern __bit errorLED;                             // defined in main.c
+
+// ---------------------------------------------------------------------------
+// UART2 interrupt service routine
+// ---------------------------------------------------------------------------
+void uart2_isr(void) __interrupt(8) __using(3) {
+
+    // UART2 transmit interrupt
+    if (S2TI) {                                    // is this a transmit interrupt?
+      CLR_S2TI;                                    // clear transmit interrupt flag
+      if (tx2_head != tx2_tail)                    // if there's another character in the transmit buffer...
+         S2BUF = tx2_buf[tx2_tail++ & (TBUFSIZE2-1)];// send it
+      else
+         tx2_busy = FALSE;                         // else the transmit buffer is empty
+    }
+
+    // UART2 receive interrupt
+    if(S2RI) {                                     // is this a receive interrupt?
+       CLR_S2RI;                                   // clear receive interrupt flag
+       ++rx2_total;
+       if (rx2_count != RBUFSIZE2) {               // unless the spool is full (the host ignored RTS)...
+          rx2_buf[rx2_head] = S2BUF;               // get character from serial port and put into the spool
+          if (++rx2_head == RBUFSIZE2) rx2_head = 0;
+          LATENCY_RECEIVED(rx2_head);              // time this character if no other is being timed
+          if (++rx2_count > rx2_highWater) rx2_highWater = rx2_count;
+       }
+       else {
+          ++rx2_overruns;                          // the character is lost
+          errorLED = TRUE;
+       }
+       if (!RTS){                                  // if communications is not now paused...
+          if ((RBUFSIZE2-rx2_count) < rx2_pauseLevel) {// if the remaining spool space is low...
+             RTS = 1;                              // pause communications
+          }
+       }
+    }
+}
+
+// ---------------------------------------------------------------------------
+//  Initialize UART2 using timer 2 for baud rate generation
+// ---------------------------------------------------------------------------
+void uart2_init(unsigned long baudrate) {
+    rx2_head = 0;                                  // initialize UART2 spool head/tail pointers.
+    rx2_tail = 0;
+    rx2_count = 0;
+    tx2_head = 0;                                  // initialize UART2 transmit buffer head/tail pointers.
+    tx2_tail = 0;
+    tx2_busy = FALSE;
+    rx2_pauseLevel = PAUSELEVEL;
+    rx2_resumeLevel = RESUMELEVEL;
+
+    CLR_T2_CT;                                     // clear T2_C/T to make Timer 2 operate as timer instead of counter
+    SET_T2x12;                                     // set T2x12=1 to make Timer 2 operate in 1T mode.
+    T2L = (65536-(FOSC/4/baudrate));               // low byte of preload
+    T2H = (65536-(FOSC/4/baudrate))>>8;            // high byte of preload
+    SET_T2R;                                       // set T2R to enable Timer 2 to run
+    S2CON = 0x50;                                  // UART2 for mode 1
+
+    SET_S2REN;                                     // set S2REN to enable reception
+    CLR_S2TI;                                      // clear S2TI, nothing is being sent
+    CLR_S2RI;                                      // clear S2RI
+    RTS = 0;                                       // clear RTS to allow transmissions from remote console
+    SET_ES2;                                       // set ES2 to enable UART2 serial interrupt
+    EA = TRUE;                                     // enable global interrupt
+}
+
+// ---------------------------------------------------------------------------
+// when 'on' is TRUE, raises RTS to pause the host and waits HOLDUSEC for any
+// character the host was already sending to arrive. when FALSE, clears RTS
+// again if there's room in the spool.
+// ---------------------------------------------------------------------------
+void uart2_hold(unsigned char on) {
+    unsigned long start;
+
+    if (on) {
+       RTS = 1;                                    // pause the host
+       start = timestamp();
+       while ((timestamp()-start) < HOLDUSEC) RESET_WDT;
+    }
+    else {
+       CLR_ES2;                                    // the ISR sets RTS too
+       if ((RBUFSIZE2-rx2_count) > rx2_resumeLevel)
+          RTS = 0;                                 // resume communications
+       SET_ES2;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// changes the UART2 baud rate. RTS pauses the host while the last character
+// is sent and Timer 2 is reloaded the same way as in uart2_init(). RTS is
+// kept high for RATEUSEC more, long enough for a host that waits for it to
+// see it high and switch its own rate, then cleared again if there's room in
+// the spool. characters already in the spool are not affected.
+// ---------------------------------------------------------------------------
+void uart2_baudrate(unsigned long baudrate) {
+    unsigned long start;
+
+    RTS = 1;                                       // pause the host
+    while (tx2_busy);                              // wait until the last character has been sent
+    CLR_T2R;                                       // stop Timer 2
+    T2L = (65536-(FOSC/4/baudrate));               // low byte of preload
+    T2H = (65536-(FOSC/4/baudrate))>>8;            // high byte of preload
+    SET_T2R;                                       // restart Timer 2
+    start = timestamp();
+    while ((timestamp()-start) < RATEUSEC) RESET_WDT;
+    uart2_hold(FALSE);                             // resume communications at the new rate
+}
+
+// ---------------------------------------------------------------------------
+// sets the spool watermarks in units of LEVELUNIT bytes. RTS pauses the host
+// when the space remaining in the spool drops below 'pauseLevel' units and
+// resumes it when the space rises above 'resumeLevel' units. returns FALSE,
+// and leaves the watermarks as they were, unless the pause level is at least
+// 1 and below the resume level and the resume level is within the spool (an
+// erased EEPROM setting, 0xFF, never is).
+// ---------------------------------------------------------------------------
+unsigned char uart2_watermarks(unsigned char pauseLevel,unsigned char resumeLevel) {
+   if (!pauseLevel || (pauseLevel >= resumeLevel) || ((unsigned int)resumeLevel*LEVELUNIT >= RBUFSIZE2)) return FALSE;
+   CLR_ES2;                                        // the ISR reads the watermarks
+   rx2_pauseLevel = (unsigned int)pauseLevel*LEVELUNIT;
+   rx2_resumeLevel = (unsigned int)resumeLevel*LEVELUNIT;
+   SET_ES2;
+   return TRUE;
+}
+
+// ---------------------------------------------------------------------------
+// returns the number of characters waiting in the UART2 receive spool.
+// the 16 bit count is updated by the ISR so it's read with the UART2
+// interrupt disabled.
+// ---------------------------------------------------------------------------
+unsigned int spooled2(void) {
+   unsigned int count;
+
+   CLR_ES2;
+   count = rx2_count;
+   SET_ES2;
+   return(count);
+}
+
+// ---------------------------------------------------------------------------
+// returns 1 if there is a character waiting in the UART2 receive spool
+// ---------------------------------------------------------------------------
+char char_avail2(void) {
+   return (spooled2() != 0);
+}
+
+//-----------------------------------------------------------
+// waits until a character is available in the UART2 receive
+// spool. returns the character. does not echo the character.
+//-----------------------------------------------------------
+char getchar2(void) {
+    unsigned char buf;
+
+    while (!spooled2());                           // wait until a character is available
+    buf = rx2_buf[rx2_tail];
+    if (++rx2_tail == RBUFSIZE2) rx2_tail = 0;     // only the tail is changed here, the ISR doesn't read it
+    CLR_ES2;                                       // the ISR updates the 16 bit count
+    --rx2_count;
+    if (RTS) {                                     // if communications is now paused...
+       if ((RBUFSIZE2-rx2_count) > rx2_resumeLevel) {
+          RTS = 0;                                 // clear RTS to resume communications when space remaining in the spool is high enough
+       }
+    }
+    SET_ES2;
+    return(buf);
+}
+
+// ---------------------------------------------------------------------------
+// puts one character into the UART2 transmit buffer. waits only if the
+// buffer is full. if the ISR isn't already sending, setting S2TI starts it.
+// ---------------------------------------------------------------------------
+char putchar2(char c)  {
+   while ((unsigned char)(tx2_head-tx2_tail) == TBUFSIZE2);// wait while the transmit buffer is full
+   tx2_buf[tx2_head & (TBUFSIZE2-1)] = c;
+   ++tx2_head;
+   if (!tx2_busy) {                                // if the ISR has emptied the transmit buffer...
+      tx2_busy = TRUE;
+      SET_S2TI;                                    // interrupt to start sending again
+   }
+   return (c);
+}
+
+// ---------------------------------------------------------------------------
+// prints the UART2 receive spool statistics on one line: the spool size,
+// the most characters ever waiting, the characters lost and received
+// ---------------------------------------------------------------------------
+void uart2_stats(void) {
+    unsigned int overruns,highWater;
+    unsigned long total;
+
+    CLR_ES2;
+    overruns = rx2_overruns;
+    highWater = rx2_highWater;
+    total = rx2_total;
+    SET_ES2;
+    printf("%-12s %5u %10u %9u %11lu\n","UART2 host",RBUFSIZE2,highWater,overruns,total);
+}
@@ -1,12 +1,17 @@
-// for the Small Device C Compiler (SDCC)
-
-#ifndef __UART2_H__
-#define __UART2_H__
-
-void uart2_isr(void) __interrupt(8) __using(3);
-void uart2_init(unsigned long baudrate);
-char char_avail2(void);
-char getchar2(void);
-char putchar2(char c);
-
-#endif
+// for the Small Device C Compiler (SDCC)
+
+#ifndef __UART2_H__
+#define __UART2_H__
+
+void uart2_isr(void) __interrupt(8) __using(3);
+void uart2_init(unsigned long baudrate);
+void uart2_baudrate(unsigned long baudrate);
+void uart2_hold(unsigned char on);
+unsigned char uart2_watermarks(unsigned char pauseLevel,unsigned char resumeLevel);
+unsigned int spooled2(void);
+char char_avail2(void);
+char getchar2(void);
+char putchar2(char c);
+void uart2_stats(void);
+
+#endif
@@ -1,525 +1,939 @@
-//************************************************************************//
-// Wheelwriter functions                                                  //
-// for the Small Device C Compiler (SDCC)                                 //
-//************************************************************************//
-
-#include <stdio.h>
-#include "reg51.h"
-#include "stc51.h"
-#include "ww-uart3.h"
-#include "ww-uart4.h"
-#include "control.h"
-
-#define FALSE 0
-#define TRUE  1
-#define ON 0                                    // 0 turns the amber LED on
-#define OFF 1                                   // 1 turns the amber LED off
-
-unsigned char uSpacesPerChar = 10;              // micro spaces per character (8 for 15cpi, 10 for 12cpi and PS, 12 for 10cpi)
-unsigned char uLinesPerLine = 16;               // micro lines per line (12 for 15cpi; 16 for 10cpi, 12cpi and PS)
-unsigned int  uSpaceCount = 0;                  // number of micro spaces on the current line (for carriage return)
-
-extern unsigned char column;                    // defined in main.c
-extern __bit localMode;                         // defined in main.c
-
-__sbit __at (0x84) P_RESET ;                    // Power-On-Reset for Printer Board output pin 5 0=on, 1=off
-__sbit __at (0x86) amberLED;                    // amber LED connected to pin 6 0=on, 1=off
-__sbit __at (0x94) F_RESET;                     // Power-On-Reset for Function Board output pin 13 0=on, 1=off
-
-//------------------------------------------------------------------------------------------------
-// ASCII character to Wheelwriter printwheel translation table used when printing to convert
-// ASCII characters to equivalent printwheel codes.
-// The Wheelwriter printwheel code indicates the position of the character on the printwheel.
-// a (code 01) is at the 12 oclock position of the printwheel. Going counter clockwise,
-// n (code 02) is next character on the printwheel followed by r (code 03), m (code 04),
-// c (code 05), s (code 06), d (code 07), h (code 08), and so on.
-// Note: non-ASCII printwheels print the following symbols:
-//    '^' prints as ''
-//    '`'   "    "  ''
-//    '~'   "    "  ''
-//    '}'   "    "  ''
-//    '{'   "    "  ''
-//    '<'   "    "  ''
-//    '>'   "    "  ''
-
-char __code ASCII2printwheel[96] =  {
-// col: 00   01   02   03   04   05   06   07   08   09   0A   0B   0C   0D   0E   0F    row:
-//      sp    !    "    #    $    %    &    '    (    )    *    +    ,    -    .    /
-       0x00,0x49,0x4B,0x38,0x37,0x39,0x3F,0x4C,0x23,0x16,0x36,0x3B,0x0C,0x0E,0x57,0x28,  // 20
-//       0    1    2    3    4    5    6    7    8    9    :    ;    <    =    >    ?
-       0x30,0x2E,0x2F,0x2C,0x32,0x31,0x33,0x35,0x34,0x2A,0x4E,0x50,0x45,0x4D,0x46,0x4A,  // 30
-//       @    A    B    C    D    E    F    G    H    I    J    K    L    M    N    O
-       0x3D,0x20,0x12,0x1B,0x1D,0x1E,0x11,0x0F,0x14,0x1F,0x21,0x2B,0x18,0x24,0x1A,0x22,  // 40
-//       P    Q    R    S    T    U    V    W    X    Y    Z    [    \    ]    ^    _
-       0x15,0x3E,0x17,0x19,0x1C,0x10,0x0D,0x29,0x2D,0x26,0x13,0x41,0x42,0x40,0x3A,0x4F,  // 50
-//       `    a    b    c    d    e    f    g    h    i    j    k    l    m    n    o
-       0x3C,0x01,0x59,0x05,0x07,0x60,0x0A,0x5A,0x08,0x5D,0x56,0x0B,0x09,0x04,0x02,0x5F,  // 60
-//       p    q    r    s    t    u    v    w    x    y    z    {    |    }    ~   DEL
-       0x5C,0x52,0x03,0x06,0x5E,0x5B,0x53,0x55,0x51,0x58,0x54,0x48,0x43,0x47,0x44,0x00}; // 70
-//------------------------------------------------------------------------------------------------
-
-//------------------------------------------------------------------------------------------------
-// Wheelwriter printwheel to ASCII character translation table used to convert
-// printwheel codes into ASCII characters when keys are pressed.
-// On an unmodified Wheelwriter keyboard with original wheelwriter keycaps:
-// the '' key produces '^'
-//     ''       "      '`'
-//     ''       "      '~'
-//     ''       "      '}'
-//     ''       "      '{'
-//     ''       "      '<'
-//     ''       "      '>'
-//     code+''  "      '|'
-//     code+']'  "      '\'
-
-char __code printwheel2ASCII[97] = {
-//       a    n    r    m    c    s    d    h    l    f    k    ,    V    _    G    U
-       0x61,0x6E,0x72,0x6D,0x63,0x73,0x64,0x68,0x6C,0x66,0x6B,0x2C,0x56,0x2D,0x47,0x55,
-//       F    B    Z    H    P    )    R    L    S    N    C    T    D    E    I    A
-       0x46,0x42,0x5A,0x48,0x50,0x29,0x52,0x4C,0x53,0x4E,0x43,0x54,0x44,0x45,0x49,0x41,
-//       J    O    (    M    .    Y    ,    /    W    9    K    3    X    1    2    0
-       0x4A,0x4F,0x28,0x4D,0x3E,0x59,0x3C,0x2F,0x57,0x39,0x4B,0x33,0x58,0x31,0x32,0x30,
-//       5    4    6    8    7    *    $    #    %    ^    +    `    @    Q    &    ]
-       0x35,0x34,0x36,0x38,0x37,0x2A,0x24,0x23,0x25,0x5E,0x2B,0x60,0x40,0x51,0x26,0x5D,
-//       }    \    |    ~            [    {    !    ?    "    '    =    :    -    ;
-       0x7D,0x5C,0x7C,0x7E,0x00,0x00,0x5B,0x7B,0x21,0x3F,0x22,0x27,0x3D,0x3A,0x5F,0x3B,
-//       x    q    v    z    w    j    .    y    b    g    u    p    i    t    o    e
-       0x78,0x71,0x76,0x7A,0x77,0x6A,0x2E,0x79,0x62,0x67,0x75,0x70,0x69,0x74,0x6F,0x65};                                                                           // 60
-//------------------------------------------------------------------------------------------------
-
-//--------------------------------------------------------------------------------------------------
-// 1 - resets the Function Board
-// 2 - resets the Printer Board
-// 3 - resets both boards
-//--------------------------------------------------------------------------------------------------
-void ww_reset(unsigned char board) {
-   unsigned char delay;
-   switch (board) {
-      case 1:                                               // reset the function board
-         F_RESET = 1;                                       // Function Board reset on                                                             // turn on reset transistor for the function board
-         break;
-      case 2:                                               // reset the printer board
-         P_RESET = 1;                                       // Printer Board reset on                                                              // turn on reset transistor for the printer board
-         break;
-      default:                                              // reset both boards
-         P_RESET = 1;                                       // Printer Board reset on
-            F_RESET = 1;                                    // Function Board reset on
-   }
-   for(delay=0;delay<110;++delay);                          // ~1 mSec delay
-    P_RESET = 0;                                            // Printer Board reset off
-    F_RESET = 0;                                            // Function Board reset off
-}
-
-//------------------------------------------------------------------------------------------------
-// backspace, no erase. decreases micro space count by uSpacesPerChar.
-//------------------------------------------------------------------------------------------------
-void ww_backspace(void) {
-    amberLED = ON;
-    send_to_printer_board_wait(0x121);
-    send_to_printer_board_wait(0x006);                      // move the carrier horizontally
-    send_to_printer_board_wait(0x000);                      // bit 7 is cleared for right to left direction
-    send_to_printer_board_wait(uSpacesPerChar);
-    uSpaceCount -= uSpacesPerChar;
-    amberLED = OFF;
-}
-
-//------------------------------------------------------------------------------------------------
-// backspace 1/120 inch. decrements micro space count
-//------------------------------------------------------------------------------------------------
-void ww_micro_backspace(void) {
-    if (uSpaceCount){                                       // only if the carrier is not at the left margin
-        amberLED = ON;
-        send_to_printer_board_wait(0x121);
-        send_to_printer_board_wait(0x006);                  // move the carrier horizontally
-        send_to_printer_board_wait(0x000);                  // bit 7 is cleared for right to left direction
-        send_to_printer_board_wait(0x001);                  // one microspace
-        --uSpaceCount;
-        amberLED = OFF;
-    }
-}
-
-//------------------------------------------------------------------------------------------------
-// To return the carrier to the left margin, the Wheelwriter requires an eleven bit number which
-// indicates the number of micro spaces to move to reach the left margin. The upper three bits of
-// the 11-bit number are sent as the 3rd word of the command, and lower 8 bits are sent as the 4th
-// word. Bit 7 of the 3rd word is cleared to indicate carriage movement left direction.
-// resets micro space count back to zero.
-//------------------------------------------------------------------------------------------------
-void ww_carriage_return(void) {
-    amberLED = ON;
-    send_to_printer_board_wait(0x121);
-    send_to_printer_board_wait(0x006);                      // move the carrier horizontallly
-    send_to_printer_board_wait((uSpaceCount>>8)&0x007);     // bit 7 is cleared for right to left direction, bits 0-2 = upper 3 bits of micro spaces to left margin
-    send_to_printer_board_wait(uSpaceCount&0xFF);           // lower 8 bits of micro spaces to left margin
-    uSpaceCount = 0;                                        // clear count
-    amberLED = OFF;
-}
-
-//------------------------------------------------------------------------------------------------
-// ww_spins the printwheel as a visual and audible indication
-//------------------------------------------------------------------------------------------------
-void ww_spin(void) {
-    amberLED = ON;
-    send_to_printer_board_wait(0x121);
-    send_to_printer_board_wait(0x007);
-    amberLED = OFF;
-}
-
-//------------------------------------------------------------------------------------------------
-// horizontal tab number of "spaces". updates micro space count.
-//------------------------------------------------------------------------------------------------
-void ww_horizontal_tab(unsigned char spaces) {
-    unsigned int s;
-
-    amberLED = ON;
-    s = spaces*uSpacesPerChar;                              // number of microspaces to move right
-    send_to_printer_board_wait(0x121);
-    send_to_printer_board_wait(0x006);                      // move the carrier horizontally
-    send_to_printer_board_wait(((s>>8)&0x007)|0x80);        // bit 7 is set for left to right direction, bits 0-2 = upper 3 bits of micro spaces to move right
-    send_to_printer_board_wait(s&0xFF);                     // lower 8 bits of micro spaces to move right
-    uSpaceCount += s;                                       // update micro space count
-    amberLED = OFF;
-}
-
-//------------------------------------------------------------------------------------------------
-// backspaces and erases "letter". updates micro space count.
-// Note: erasing bold or underlined characters or characters on
-// lines other than the current line is not implemented yet.
-//------------------------------------------------------------------------------------------------
-void ww_erase_letter(unsigned char letter) {
-     amberLED = ON;
-     send_to_printer_board_wait(0x121);
-     send_to_printer_board_wait(0x006);                  // move the carrier horizontally
-     send_to_printer_board_wait(0x000);                  // bit 7 is cleared for right to left direction
-     send_to_printer_board_wait(uSpacesPerChar);         // number of micro spaces to move left
-     send_to_printer_board_wait(0x121);
-     send_to_printer_board_wait(0x004);                  // print on correction tape
-     send_to_printer_board_wait(ASCII2printwheel[letter-0x20]);
-     send_to_printer_board_wait(uSpacesPerChar);         // number of micro spaces to move right
-     uSpaceCount -= uSpacesPerChar;                      // update the micro space count
-     amberLED = OFF;
-}
-
-//------------------------------------------------------------------------------------------------
-// paper up one line
-//------------------------------------------------------------------------------------------------
-void ww_linefeed(void) {
-    amberLED = ON;
-    send_to_printer_board_wait(0x121);
-    send_to_printer_board_wait(0x005);                      // vertical movement
-    send_to_printer_board_wait(0x080|uLinesPerLine);        // bit 7 is set to indicate paper up direction, bits 0-4 indicate number of microlines for 1 full line
-    amberLED = OFF;
-}
-
-//------------------------------------------------------------------------------------------------
-// paper down one line
-//------------------------------------------------------------------------------------------------
-void ww_reverse_linefeed(void) {
-    amberLED = ON;
-    send_to_printer_board_wait(0x121);
-    send_to_printer_board_wait(0x005);                      // vertical movement
-    send_to_printer_board_wait(0x000|uLinesPerLine);        // bit 7 is cleared to indicate paper down direction, bits 0-4 indicate number of microlines for 1 full line
-    amberLED = OFF;
-}
-
-//------------------------------------------------------------------------------------------------
-// paper up 1/2 line
-//------------------------------------------------------------------------------------------------
-void ww_paper_up(void) {
-    amberLED = ON;
-    send_to_printer_board_wait(0x121);
-    send_to_printer_board_wait(0x005);                      // vertical movement
-    send_to_printer_board_wait(0x080|(uLinesPerLine>>1));   // bit 7 is set to indicate up direction, bits 0-3 indicate number of microlines for 1/2 line
-    amberLED = OFF;
-}
-
-//------------------------------------------------------------------------------------------------
-// paper down 1/2 line
-//------------------------------------------------------------------------------------------------
-void ww_paper_down(void) {
-    amberLED = ON;
-    send_to_printer_board_wait(0x121);
-    send_to_printer_board_wait(0x005);                      // vertical movement
-    send_to_printer_board_wait(0x000|(uLinesPerLine>>1));   // bit 7 is cleared to indicate down direction, bits 0-3 indicate number of microlines for 1/2 full line
-    amberLED = OFF;
-}
-
-//------------------------------------------------------------------------------------------------
-// paper up 1/8 line
-//------------------------------------------------------------------------------------------------
-void ww_micro_up(void) {
-    amberLED = ON;
-    send_to_printer_board_wait(0x121);
-    send_to_printer_board_wait(0x005);                      // vertical movement
-    send_to_printer_board_wait(0x080|(uLinesPerLine>>3));   // bit 7 is set to indicate up direction, bits 0-3 indicate number of microlines for 1/8 full line or 1/48"
-    amberLED = OFF;
-}
-
-//------------------------------------------------------------------------------------------------
-// paper down 1/8 line
-//------------------------------------------------------------------------------------------------
-void ww_micro_down(void) {
-    amberLED = ON;
-    send_to_printer_board_wait(0x121);
-    send_to_printer_board_wait(0x005);                      // vertical movement
-    send_to_printer_board_wait(0x000|(uLinesPerLine>>3));   // bit 7 is cleared to indicate down direction, bits 0-3 indicate number of microlines for 1/8 full line or 1/48"
-    amberLED = OFF;
-}
-
-//-----------------------------------------------------------
-// Sends the printwheel code for the ASCII "letter" to be printed
-// to the printer board on the Wheelwriter.
-// Handles bold, continuous and multiple word underline printing.
-// Carrier moves to the right by uSpacesPerChar.
-// Increases the micro space count by uSpacesPerChar for each letter printed.
-//-----------------------------------------------------------
-void ww_print_character(unsigned char letter,unsigned char attribute) {
-     amberLED = ON;
-     send_to_printer_board_wait(0x121);
-     send_to_printer_board_wait(0x003);
-     send_to_printer_board_wait(ASCII2printwheel[letter-0x20]);// ascii character (-0x20) as index to printwheel table
-     if ((attribute & 0x06) && ((letter!=0x20) || (attribute & 0x02))){// if underlining AND the letter is not a space OR continuous underlining is on
-         send_to_printer_board_wait(0x000);              // advance zero micro spaces
-         send_to_printer_board_wait(0x121);
-         send_to_printer_board_wait(0x003);
-         send_to_printer_board_wait(0x04F);              // print '_' underscore
-     }
-     if (attribute & 0x01) {                             // if the bold bit is set
-         send_to_printer_board_wait(0x001);              // advance carriage by one micro space
-         send_to_printer_board_wait(0x121);
-         send_to_printer_board_wait(0x003);
-         send_to_printer_board_wait(ASCII2printwheel[letter-0x20]);// re-print the character offset by one micro space
-         send_to_printer_board_wait((uSpacesPerChar)-1); // advance carriage the remaining micro spaces
-     }
-     else { // not boldprint
-         send_to_printer_board_wait(uSpacesPerChar);
-     }
-
-     uSpaceCount += uSpacesPerChar;                      // update the micro space count
-     if (uSpaceCount > 1450) {                           // right stop
-         ww_carriage_return();                           // automatically return to left margin
-         column = 1;
-     }
-     amberLED = OFF;
-}
-
-//--------------------------------------------------------------------------------------------------
-// Decodes the 9 bit words sent by the Wheelwriter Function Board to the Printer Board when keys
-// are pressed and returns the equivalent ASCII character (if there is one). Typically a sequence of a
-// minimum of three words (sometimes more, depending on the key) is required to decode each keypress.
-// Call this function for each word received from the Function Board. Intermediate words return zeros.
-//
-// In 'local' Mode, sends vertical movement commands (Paper Up, Paper Down, Micro Up, Micro
-// Down and SAPI) to the printer board. Vertical movement commands ignored when not in 'local' mode.
-// Horizontal movement commands are returned as Space, Backspace and Tab characters.
-//
-// Code key combinations are returned as control keys i.e. Code+C is returned as Control C.
-//
-// The Code+Erase key combo returns 0xF0 which, when seen by the main() function,  is used to toggle between
-// 'line' and 'local' modes.
-//--------------------------------------------------------------------------------------------------
-char ww_decode_keys(unsigned int WWdata) {
-    static unsigned char keystate = 0xFF;
-    static unsigned int lastWWdata = 0;
-    char result;
-
-    result = 0;
-    switch(keystate) {
-        case 0xFF:                                          // waiting for first data word from Wheelwriter...
-            if (WWdata == 0x121)                            // all commands must start with 0x121...
-               keystate = 0xFE;
-            break;
-        case 0xFE:                                          // 0x121 has been received...
-            switch(WWdata) {
-                case 0x003:                                 // 0x121,0x003 is start of alpha-numeric character sequence
-                    keystate = 0x30;
-                    break;
-                case 0x005:                                 // 0x121,0x005 is start of vertical movement sequence
-                    keystate = 0x50;
-                    break;
-                case 0x006:                                 // 0x121,0x006 is start of horizontal movement sequence
-                    keystate = 0x60;
-                    break;
-                case 0x00E:                                 // 0x121,0x00E is the start of a code key sequence
-                    keystate = 0xE0;
-                    break;
-                default:
-                    keystate = 0xFF;                        // anything else
-            } // switch(WWdata)
-            break;
-        case 0x30:                                          // 0x121,0x003 has been received...
-            keystate = 0x31;                                // must wait for the microspaces value to follow
-            break;
-        case 0x31:                                          // 0x121,0x003,printwheel code  has been received, waiting for microspaces...
-            keystate = 0xFF;                                // reset keystate back to start
-            result = printwheel2ASCII[(lastWWdata-1)];      // get the ASCII code from the translation table
-            break;
-        case 0x50:                                          // 0x121,0x005 has been received, move paper vertically...
-            keystate = 0xFF;
-            if (((WWdata&0x1F)==uLinesPerLine)&&(WWdata&0x80))// one line AND paper up direction
-                result = CR;                                // LF used to detect when C Rtn key is pressed
-            if (localMode) {                                // if 'local' mode...
-                send_to_printer_board_wait(0x121);          // pass all vertical commands thru...
-                send_to_printer_board_wait(0x005);          // Paper Up, Paper Down, Micro Up, Micro Down and SAPI
-                send_to_printer_board_wait(WWdata);
-            }
-            break;
-        case 0x60:                                          // 0x121,0x006 has been received...
-            if (WWdata & 0x080)                             // if bit 7 is set...
-               keystate = 0x61;                             // 0x121,0x006,0x080 is horizontal movement to the right...
-            else                                            // else...
-               keystate = 0x62;                             // 0x121,0x006,0x000 is horizontal movement to the left...
-            break;
-        case 0x61:                                          // 0x121,0x006,0x08X has been received, move carrier to the right...
-            keystate = 0xFF;
-            if ((WWdata>uSpacesPerChar)&&(WWdata<uSpacesPerChar*10)) // if more than one space but less than 10 spaces, must be horizontal tab
-                result = HT;
-            else if (WWdata==uSpacesPerChar)
-                result = SP;
-            break;
-        case 0x62:                                          // 0x121,0x006,0x00X has been received, move carrier to the left...
-            keystate = 0xFF;
-            if (WWdata==uSpacesPerChar)
-                result = BS;
-            break;
-        case 0xE0:                                          // 0x121,0x00E has been received (code key combination)
-            keystate = 0xFF;
-            // convert code key combinations into control keys i.e. code+C is converted into control C
-            switch(WWdata & 0x07F) {                        // bit 7 is cleared on WW3, set on WW6
-                case 0x001:                                 // Code+1
-                    break;
-                case 0x002:                                 // Code+Q
-                    result = DC1;                           // converted to ^Q
-                    break;
-                case 0x004:                                 // Code+A
-                    result = SOH;                           // converted to ^A
-                    break;
-                case 0x006:                                   // Code+Z
-                    result = SUB;                           // converted to ^Z
-                    break;
-                case 0x009:                                 // Code+2
-                    break;
-                case 0x00A:                                 // Code+W
-                    result = ETB;                           // converted to ^W
-                    break;
-                case 0x00C:                                 // Code+S
-                    result = DC3;                           // converted to ^S
-                    break;
-                case 0x00E:                                 // Code+X
-                    result = CAN;                           // converted to ^X
-                    break;
-                case 0x011:                                 // Code+3
-                    break;
-                case 0x012:                                 // Code+E
-                    result = ENQ;                           // converted to ^E
-                    break;
-                case 0x014:                                 // Code+D
-                    result = EOT;                           // converted to ^D
-                    break;
-                case 0x016:                                   // Code+C
-                    result = ETX;                           // converted to ^C
-                    break;
-                case 0x018:                                 // Code+5
-                    break;
-                case 0x019:                                 // Code+4
-                    break;
-                case 0x01A:                                 // Code+R
-                    result = DC2;                           // converted to ^R
-                    break;
-                case 0x01B:                                 // Code+T
-                    result = DC4;                           // converted to ^T
-                    break;
-                case 0x01C:                                 // Code+F
-                    result = ACK;                           // converted to ^F
-                    break;
-                case 0x01D:                                   // Code+G
-                    result = BEL;                           // converted to ^G
-                    break;
-                case 0x01E:                                 // Code+V
-                    result = SYN;                           // converted to ^V
-                    break;
-                case 0x01F:                                 // Code+B
-                    result = STX;                           // converted to ^B
-                    break;
-                case 0x020:                                 // Code+6
-                    break;
-                case 0x021:                                 // Code+7
-                    break;
-                case 0x022:                                 // Code+U
-                    result = NAK;                           // converted to ^U
-                    break;
-                case 0x023:                                 // Code+Y
-                    result = EM;                            // converted to ^Y
-                    break;
-                case 0x024:                                   // Code+J
-                    result = LF;                            // converted to ^J
-                    break;
-                case 0x025:                                   // Code+H
-                    result = BS;                            // converted to ^H
-                    break;
-                case 0x026:                                   // Code+M
-                    result = CR;                            // converted to ^M
-                    break;
-                case 0x029:                                 // Code+8
-                    break;
-                case 0x02A:                                   // Code+I
-                    result = HT;                            // converted to ^I
-                    break;
-                case 0x02C:                                   // Code+K
-                    result = VT;                            // converted to ^K
-                    break;
-                case 0x031:                                 // Code+9
-                    break;
-                case 0x032:                                 // Code+O
-                    result = SI;                            // converted to ^O
-                    break;
-                case 0x034:                                   // Code+L
-                    result = FF;                            // converted to ^L
-                    break;
-                case 0x039:                                 // Code+0
-                    break;
-                case 0x03A:                                 // Code+P
-                    result = DLE;                           // converted to ^P
-                    break;
-                case 0x042:                                 // Code+L Mar
-                    break;
-                case 0x045:                                 // Code+T Clr
-                    break;
-                case 0x046:                                 // Code+Micro Dn
-                    break;
-                case 0x047:                                 // Code+Space
-                    break;
-                case 0x048:                                 // Code+Mar Rel
-                    result = ESC;                           // converted to Escape
-                    break;
-                case 0x04A:                                 // Code+Tab
-                    break;
-                case 0x04B:                                 // Code+R Mar
-                    break;
-                case 0x04C:                                 // Code+T Set
-                    break;
-                case 0x4F:                                  // Code+Erase
-                    result = 0xF0;                          // return 0xF0 for Code+Erase key combo to toggle line/local mode flag
-                    break;
-                case 0x051:                                 // Code+Paper Up
-                    break;
-                case 0x052:                                 // Code+Paper Dn
-                    break;
-                case 0x054:                                 // Code+Micro Up
-                    break;
-                case 0x056:                                 // Code+C Rtn
-                    break;
-                case 0x057:                                 // Code+Line Space
-                    break;
-                case 0x067:                                 // code key released
-                    break;
-                case 0x076:                                 // Code+N
-                    result = SO;                            // converted to ^N
-                    break;
-            } // switch(WWdata & 0x17F)
-            break;
-    }   // switch(keystate)
-    lastWWdata = WWdata;                                    // save for next time
-    return(result);
-}
-
+//************************************************************************//
+// Wheelwriter functions                                                  //
+// for the Small Device C Compiler (SDCC)                                 //
+//************************************************************************//
+
+#include <stdio.h>
+#include "hal.h"
+#include "reg51.h"
+#include "stc51.h"
+#include "ww-uart3.h"
+#include "ww-uart4.h"
+#include "control.h"
+#include "wheelwriter.h"
+#include "eeprom.h"
+
+#define FALSE 0
+#define TRUE  1
+
+#define LINEBUFSIZE 160                         // number of strikes the line buffer holds
+#define RIGHTSTOP 1450                          // micro spaces from the left margin to the right stop
+#define SPOKES 96                               // number of characters on the printwheel
+#define WHEELSETTLE 8                           // cost of starting and stopping the printwheel (in micro spaces of carrier travel)
+#define WHEELPERSPOKE 2                         // cost of turning the printwheel one spoke (in micro spaces of carrier travel)
+#define CARRIERSTART 20                         // cost of starting and stopping the carrier (in micro spaces of carrier travel)
+#define CARRIERMOVE 1                           // cost of the bus words of a carrier move command (in micro spaces of carrier travel)
+#define STRIKE_TIMED 0x80                       // set in a printwheel code, marks a strike timed by latency.c
+#define PRINTED 0x8000                          // set in a buffered position while ordering a line, positions are below RIGHTSTOP
+
+unsigned char uSpacesPerChar = 10;              // micro spaces per character (8 for 15cpi, 10 for 12cpi and PS, 12 for 10cpi)
+unsigned char uLinesPerLine = 16;               // micro lines per line (12 for 15cpi; 16 for 10cpi, 12cpi and PS)
+unsigned int  uSpaceCount = 0;                  // number of micro spaces from the left margin to where the carrier is
+unsigned int  uSpaceTarget = 0;                 // number of micro spaces from the left margin to where the next character prints
+__bit lineBuffering = FALSE;                    // when true, characters are buffered and printed a line at a time in either direction
+__bit strikeOrdering = FALSE;                   // when true, buffered lines are printed in the order that minimizes printwheel and carrier travel
+unsigned char wheelPosition = 0x01;             // printwheel code of the last character struck
+__bit strikeTiming = FALSE;                     // when true, the strikes made are marked for latency.c
+
+int  __xdata uLinePending = 0;                  // micro lines of paper movement not yet sent (positive is paper up)
+unsigned int __xdata uLinePosition = 0;         // micro lines from the top of form to the print line
+unsigned int __xdata uLinesPerPage = 66*16;     // micro lines per page (11 inch page)
+
+unsigned char lineCount = 0;                    // number of strikes in the line buffer
+unsigned int  __xdata linePosition[LINEBUFSIZE];// micro space position of each buffered strike
+unsigned char __xdata lineCode[LINEBUFSIZE];    // printwheel code of each buffered strike, with STRIKE_TIMED if it's timed
+unsigned char __xdata wheelCost[SPOKES/2+1];    // cost of turning the printwheel 0-48 spokes
+unsigned char __xdata carrierStart;             // cost of starting and stopping the carrier
+unsigned char __xdata carrierMove;              // cost of the bus words of a carrier move command
+unsigned char __xdata strikesTimed = 0;         // strikes marked since strikeTiming was last set
+
+extern unsigned char column;                    // defined in diablo.c
+extern __bit localMode;                         // defined in main.c
+extern __bit passthrough;                       // defined in main.c
+
+__sbit __at (0x84) P_RESET ;                    // Power-On-Reset for Printer Board output pin 5 0=on, 1=off
+__sbit __at (0x94) F_RESET;                     // Power-On-Reset for Function Board output pin 13 0=on, 1=off
+
+//------------------------------------------------------------------------------------------------
+// ASCII character to Wheelwriter printwheel translation table used when printing to convert
+// ASCII characters to equivalent printwheel codes.
+// The Wheelwriter printwheel code indicates the position of the character on the printwheel.
+// “a” (code 01) is at the 12 o’clock position of the printwheel. Going counter clockwise,
+// “n” (code 02) is next character on the printwheel followed by “r” (code 03), “m” (code 04),
+// “c” (code 05), “s” (code 06), “d” (code 07), “h” (code 08), and so on.
+// Note: non-ASCII printwheels print the following symbols:
+//    '^' prints as '¢'
+//    '`'   "    "  '±'
+//    '~'   "    "  '°'
+//    '}'   "    "  '½'
+//    '{'   "    "  '¼'
+//    '<'   "    "  '§'
+//    '>'   "    "  '¶'
+
+char __code ASCII2printwheel[96] =  {
+// col: 00   01   02   03   04   05   06   07   08   09   0A   0B   0C   0D   0E   0F    row:
+//      sp    !    "    #    $    %    &    '    (    )    *    +    ,    -    .    /
+       0x00,0x49,0x4B,0x38,0x37,0x39,0x3F,0x4C,0x23,0x16,0x36,0x3B,0x0C,0x0E,0x57,0x28,  // 20
+//       0    1    2    3    4    5    6    7    8    9    :    ;    <    =    >    ?
+       0x30,0x2E,0x2F,0x2C,0x32,0x31,0x33,0x35,0x34,0x2A,0x4E,0x50,0x45,0x4D,0x46,0x4A,  // 30
+//       @    A    B    C    D    E    F    G    H    I    J    K    L    M    N    O
+       0x3D,0x20,0x12,0x1B,0x1D,0x1E,0x11,0x0F,0x14,0x1F,0x21,0x2B,0x18,0x24,0x1A,0x22,  // 40
+//       P    Q    R    S    T    U    V    W    X    Y    Z    [    \    ]    ^    _
+       0x15,0x3E,0x17,0x19,0x1C,0x10,0x0D,0x29,0x2D,0x26,0x13,0x41,0x42,0x40,0x3A,0x4F,  // 50
+//       `    a    b    c    d    e    f    g    h    i    j    k    l    m    n    o
+       0x3C,0x01,0x59,0x05,0x07,0x60,0x0A,0x5A,0x08,0x5D,0x56,0x0B,0x09,0x04,0x02,0x5F,  // 60
+//       p    q    r    s    t    u    v    w    x    y    z    {    |    }    ~   DEL
+       0x5C,0x52,0x03,0x06,0x5E,0x5B,0x53,0x55,0x51,0x58,0x54,0x48,0x43,0x47,0x44,0x00}; // 70
+//------------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------------
+// Wheelwriter printwheel to ASCII character translation table used to convert
+// printwheel codes into ASCII characters when keys are pressed.
+// On an unmodified Wheelwriter keyboard with original wheelwriter keycaps:
+// the '¢' key produces '^'
+//     '±'       "      '`'
+//     '°'       "      '~'
+//     '½'       "      '}'
+//     '¼'       "      '{'
+//     '§'       "      '<'
+//     '¶'       "      '>'
+//     code+'½'  "      '|'
+//     code+']'  "      '\'
+
+char __code printwheel2ASCII[97] = {
+//       a    n    r    m    c    s    d    h    l    f    k    ,    V    _    G    U
+       0x61,0x6E,0x72,0x6D,0x63,0x73,0x64,0x68,0x6C,0x66,0x6B,0x2C,0x56,0x2D,0x47,0x55,
+//       F    B    Z    H    P    )    R    L    S    N    C    T    D    E    I    A
+       0x46,0x42,0x5A,0x48,0x50,0x29,0x52,0x4C,0x53,0x4E,0x43,0x54,0x44,0x45,0x49,0x41,
+//       J    O    (    M    .    Y    ,    /    W    9    K    3    X    1    2    0
+       0x4A,0x4F,0x28,0x4D,0x3E,0x59,0x3C,0x2F,0x57,0x39,0x4B,0x33,0x58,0x31,0x32,0x30,
+//       5    4    6    8    7    *    $    #    %    ^    +    `    @    Q    &    ]
+       0x35,0x34,0x36,0x38,0x37,0x2A,0x24,0x23,0x25,0x5E,0x2B,0x60,0x40,0x51,0x26,0x5D,
+//       }    \    |    ~    §    ¶    [    {    !    ?    "    '    =    :    -    ;
+       0x7D,0x5C,0x7C,0x7E,0x00,0x00,0x5B,0x7B,0x21,0x3F,0x22,0x27,0x3D,0x3A,0x5F,0x3B,
+//       x    q    v    z    w    j    .    y    b    g    u    p    i    t    o    e
+       0x78,0x71,0x76,0x7A,0x77,0x6A,0x2E,0x79,0x62,0x67,0x75,0x70,0x69,0x74,0x6F,0x65};                                                                           // 60
+//------------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------------
+// The printwheel codes above number the spokes of the printwheel consecutively counter clockwise
+// from 'a' (code 01) to 'e' (code 96), so the printwheel turns the shorter way round between two
+// characters through min(|code1-code2|,96-|code1-code2|) spokes. ww_cost_model() fills wheelCost[]
+// with the cost of turning the printwheel through 0 to 48 spokes, expressed in micro spaces of
+// carrier travel so that printwheel and carrier travel can be added together. "start" is the
+// cost of starting and stopping the carrier, paid by every strike that isn't at the position
+// of the one before, whether the carrier gets there by the strike's advance or by a move.
+// "move" is the cost of sending the move command, paid when the advance can't get there.
+//------------------------------------------------------------------------------------------------
+void ww_cost_model(unsigned char settle,unsigned char perSpoke,unsigned char start,unsigned char move) {
+    unsigned char d;
+
+    carrierStart = start;
+    carrierMove = move;
+    wheelCost[0] = 0;                                       // same character, the printwheel does not turn
+    for(d=1; d<=SPOKES/2; d++)
+        wheelCost[d] = settle+(perSpoke*d);
+}
+
+//------------------------------------------------------------------------------------------------
+// initializes the cost model used for strike ordering, with the costs measured by calibrate_run()
+// if the machine has been calibrated
+//------------------------------------------------------------------------------------------------
+void ww_init(void) {
+    unsigned char settle,perSpoke,start,move;
+
+    settle = get_setting(EE_WHEELSETTLE);
+    perSpoke = get_setting(EE_WHEELPERSPOKE);
+    if ((settle == 0xFF) || (perSpoke == 0xFF)) {           // not calibrated
+        settle = WHEELSETTLE;
+        perSpoke = WHEELPERSPOKE;
+    }
+    start = get_setting(EE_CARRIERSTART);
+    move = get_setting(EE_CARRIERMOVE);
+    if ((start == 0xFF) || (move == 0xFF)) {                // not calibrated, or calibrated before they were measured
+        start = CARRIERSTART;
+        move = CARRIERMOVE;
+    }
+    ww_cost_model(settle,perSpoke,start,move);
+}
+
+//------------------------------------------------------------------------------------------------
+// returns the number of spokes the printwheel turns going from code1 to code2
+//------------------------------------------------------------------------------------------------
+unsigned char ww_wheel_distance(unsigned char code1,unsigned char code2) {
+    unsigned char d;
+
+    d = (code1 > code2) ? code1-code2 : code2-code1;
+    return (d > SPOKES/2) ? SPOKES-d : d;
+}
+
+//--------------------------------------------------------------------------------------------------
+// 1 - resets the Function Board
+// 2 - resets the Printer Board
+// 3 - resets both boards
+//--------------------------------------------------------------------------------------------------
+void ww_reset(unsigned char board) {
+   unsigned char delay;
+   switch (board) {
+      case 1:                                               // reset the function board
+         F_RESET = 1;                                       // Function Board reset on
+         break;
+      case 2:                                               // reset the printer board
+         P_RESET = 1;                                       // Printer Board reset on
+         break;
+      default:                                              // reset both boards
+         P_RESET = 1;                                       // Printer Board reset on
+         F_RESET = 1;                                       // Function Board reset on
+   }
+   for(delay=0; delay<110; ++delay)                         // ~1 mSec delay
+      ;
+   P_RESET = 0;                                             // Printer Board reset off
+   F_RESET = 0;                                             // Function Board reset off
+}
+
+//------------------------------------------------------------------------------------------------
+// Spaces, tabs, backspaces and carriage returns only change uSpaceTarget, the logical carrier
+// position. The carrier itself is moved, with a single horizontal movement command, only when
+// the next character is struck (or when ww_flush() is called). A run of spaces or a carriage
+// return followed by indentation thus costs one move instead of many.
+//------------------------------------------------------------------------------------------------
+
+//------------------------------------------------------------------------------------------------
+// moves the carrier from micro space position uSpaceCount to "position" with a single horizontal
+// movement command. bit 7 of the 3rd word sets the direction, bits 0-2 of the 3rd word and the
+// 8 bits of the 4th word are the 11-bit number of micro spaces to move.
+//------------------------------------------------------------------------------------------------
+void ww_move_carrier(unsigned int position) {
+    unsigned int s;
+
+    if (position == uSpaceCount) return;                    // already there
+    send_to_printer_board_queued(0x121);
+    send_to_printer_board_queued(0x006);                    // move the carrier horizontally
+    if (position > uSpaceCount) {
+        s = position-uSpaceCount;                           // number of micro spaces to move right
+        send_to_printer_board_queued(((s>>8)&0x007)|0x80);  // bit 7 is set for left to right direction
+    }
+    else {
+        s = uSpaceCount-position;                           // number of micro spaces to move left
+        send_to_printer_board_queued((s>>8)&0x007);         // bit 7 is cleared for right to left direction
+    }
+    send_to_printer_board_queued(s&0xFF);                   // lower 8 bits of micro spaces to move
+    uSpaceCount = position;
+}
+
+//------------------------------------------------------------------------------------------------
+// strikes printwheel "code" at the current carrier position, then advances the carrier "advance"
+// micro spaces to the right. if STRIKE_TIMED is set in "code", the last word of the command is
+// marked PB_TIMED so that the UART4 ISR tells latency.c when the strike is acknowledged.
+//------------------------------------------------------------------------------------------------
+void ww_strike(unsigned char code,unsigned char advance) {
+    ww_move_paper();                                        // first any vertical movement since the last strike
+    send_to_printer_board_queued(0x121);
+    send_to_printer_board_queued(0x003);
+    send_to_printer_board_queued(code & ~STRIKE_TIMED);
+    send_to_printer_board_queued((code & STRIKE_TIMED) ? advance|PB_TIMED : advance);
+    uSpaceCount += advance;
+    if (code & ~STRIKE_TIMED) wheelPosition = code & ~STRIKE_TIMED;
+}
+
+//------------------------------------------------------------------------------------------------
+// returns "code" with STRIKE_TIMED set, and counts it, if the strikes being made are timed.
+// printwheel code 0x00 (space) strikes nothing and is never timed.
+//------------------------------------------------------------------------------------------------
+unsigned char ww_timed(unsigned char code) {
+    if (!strikeTiming || !code) return code;
+    ++strikesTimed;
+    return code|STRIKE_TIMED;
+}
+
+//------------------------------------------------------------------------------------------------
+// when "on" is TRUE, the strikes made from now on are marked for latency.c, wherever they end up
+// in the order the line is printed, and counted from zero. when FALSE, stops marking them.
+//------------------------------------------------------------------------------------------------
+void ww_time_strikes(unsigned char on) {
+    if (on) strikesTimed = 0;
+    strikeTiming = on;
+}
+
+//------------------------------------------------------------------------------------------------
+// returns the number of strikes marked since ww_time_strikes(TRUE)
+//------------------------------------------------------------------------------------------------
+unsigned char ww_strikes_timed(void) {
+    return strikesTimed;
+}
+
+//------------------------------------------------------------------------------------------------
+// adds a strike of printwheel "code" at micro space "position" to the line buffer. printwheel
+// code 0x00 (space) strikes nothing and is not buffered.
+//------------------------------------------------------------------------------------------------
+void ww_buffer_strike(unsigned int position,unsigned char code) {
+    if (code) {
+        linePosition[lineCount] = position;
+        lineCode[lineCount] = ww_timed(code);
+        ++lineCount;
+    }
+}
+
+//------------------------------------------------------------------------------------------------
+// moves the carrier to "position" and strikes "code". if the following strike at "next" is no
+// more than one character to the right, the strike advances the carrier there.
+//------------------------------------------------------------------------------------------------
+void ww_line_strike(unsigned int position,unsigned char code,unsigned int next) {
+    ww_move_carrier(position);
+    ww_strike(code,((next >= position) && (next-position <= uSpacesPerChar)) ? next-position : 0);
+}
+
+//------------------------------------------------------------------------------------------------
+// returns the cost of going from a strike of printwheel code "wheel" at micro space "position" to
+// the strike in line buffer entry "i". carrier travel costs one per micro space plus carrierStart
+// if the carrier moves at all, plus carrierMove if it's out of reach of the strike's advance (see
+// ww_line_strike()). printwheel travel is looked up in wheelCost[].
+//------------------------------------------------------------------------------------------------
+unsigned int ww_strike_cost(unsigned int position,unsigned char wheel,unsigned char i) {
+    unsigned int cost;
+
+    cost = (linePosition[i] > position) ? linePosition[i]-position : position-linePosition[i];
+    if (cost) cost += carrierStart;
+    if ((linePosition[i] < position) || (linePosition[i]-position > uSpacesPerChar)) cost += carrierMove;
+    return cost+wheelCost[ww_wheel_distance(wheel,lineCode[i] & ~STRIKE_TIMED)];
+}
+
+//------------------------------------------------------------------------------------------------
+// returns the cost of ending a line at micro space "position": the next line is printed from
+// whichever of its ends is nearer, so ending away from the ends of this line costs about the
+// distance to the nearer one on the next line.
+//------------------------------------------------------------------------------------------------
+unsigned int ww_end_cost(unsigned int position) {
+    unsigned int left,right;
+
+    left = position-linePosition[0];
+    right = linePosition[lineCount-1]-position;
+    return (left < right) ? left : right;
+}
+
+//------------------------------------------------------------------------------------------------
+// works out the order that keeps the time taken by the printwheel and carrier low for the strikes
+// in the sorted line buffer, and prints them in that order if "strike" is TRUE. starting from the
+// current carrier and printwheel positions, the next strike is always the one that costs least to
+// reach. strikes at the same position are kept in the order they were buffered in so that
+// overstruck characters look the same on paper. the strikes already ordered are marked by setting
+// PRINTED in linePosition[], the marks are cleared again before returning. returns the total cost,
+// including ww_end_cost().
+//------------------------------------------------------------------------------------------------
+unsigned long ww_print_line_ordered(unsigned char strike) {
+    unsigned char i,j,best,previous,code,wheel;
+    unsigned int position,cost,bestCost;
+    unsigned long total = 0;
+
+    position = uSpaceCount;
+    wheel = wheelPosition;
+    previous = 0xFF;
+    code = 0;
+    for(i=0; i<lineCount; i++) {
+        bestCost = 0xFFFF;
+        best = 0;
+        for(j=0; j<lineCount; j++) {
+            if (linePosition[j] & PRINTED) continue;        // already ordered
+            if (j && (linePosition[j-1] == linePosition[j])) continue; // overstrike not yet due
+            cost = ww_strike_cost(position,wheel,j);
+            if (cost < bestCost) {
+                bestCost = cost;
+                best = j;
+            }
+        }
+        total += bestCost;
+        if (strike && (previous != 0xFF))
+            ww_line_strike(position,code,linePosition[best]);
+        code = lineCode[best];
+        position = linePosition[best];
+        linePosition[best] |= PRINTED;                      // mark as ordered
+        previous = best;
+        wheel = code & ~STRIKE_TIMED;
+    }
+    if (strike) ww_line_strike(position,code,position);
+    for(i=0; i<lineCount; i++)
+        linePosition[i] &= ~PRINTED;
+    return total+ww_end_cost(position);
+}
+
+//------------------------------------------------------------------------------------------------
+// returns the cost of printing the sorted line buffer the way ww_print_pass() does: the letters
+// in one direction, then the underscores on the way back, including ww_end_cost().
+//------------------------------------------------------------------------------------------------
+unsigned long ww_passes_cost(unsigned char rightToLeft) {
+    unsigned char i,n,pass,wheel,code;
+    unsigned int position;
+    unsigned long total = 0;
+
+    position = uSpaceCount;
+    wheel = wheelPosition;
+    for(pass=0; pass<2; pass++) {                           // the letters, then the underscores
+        for(n=0; n<lineCount; n++) {
+            i = (rightToLeft != pass) ? lineCount-1-n : n;
+            code = lineCode[i] & ~STRIKE_TIMED;
+            if ((code == 0x04F) != pass) continue;
+            total += ww_strike_cost(position,wheel,i);
+            position = linePosition[i];
+            wheel = code;
+        }
+    }
+    return total+ww_end_cost(position);
+}
+
+//------------------------------------------------------------------------------------------------
+// makes one pass along the sorted line buffer, left to right or right to left, printing either
+// the underscores or everything else.
+//------------------------------------------------------------------------------------------------
+void ww_print_pass(unsigned char rightToLeft,unsigned char underscores) {
+    unsigned char i,n,previous;
+
+    previous = 0xFF;
+    for(n=0; n<lineCount; n++) {
+        i = rightToLeft ? lineCount-1-n : n;
+        if (((lineCode[i] & ~STRIKE_TIMED) == 0x04F) != underscores) continue;
+        if (previous != 0xFF)
+            ww_line_strike(linePosition[previous],lineCode[previous],linePosition[i]);
+        previous = i;
+    }
+    if (previous != 0xFF)
+        ww_line_strike(linePosition[previous],lineCode[previous],linePosition[previous]);
+}
+
+//------------------------------------------------------------------------------------------------
+// prints the strikes in the line buffer and empties it. the strikes are sorted by position
+// (strikes at the same position keep the order they were buffered in) and printed starting
+// from whichever end of the line is nearer to the carrier, so that after a carriage return
+// successive lines are printed alternately left to right and right to left without moving
+// the carrier back to the left margin. left to right, each strike advances the carrier to the
+// next strike when it is no more than one character away. right to left, each character is
+// struck with zero advance and followed by a leftward move to the next one.
+// the letters are printed first, then the underscores are printed in one sweep back in the
+// other direction, so the printwheel does not have to turn between each underlined letter and
+// its underscore.
+// if strikeOrdering is on, the order ww_print_line_ordered() picks is used instead, unless it
+// costs more than the two passes. ordering nearest first can leave strikes behind and come back
+// for them, so on some lines it's the slower of the two.
+//------------------------------------------------------------------------------------------------
+void ww_print_line(void) {
+    unsigned char i,j,code,rightToLeft;
+    unsigned int position,left,right;
+
+    if (!lineCount) return;                                 // nothing buffered
+
+    for(i=1; i<lineCount; i++) {                            // insertion sort by position
+        position = linePosition[i];
+        code = lineCode[i];
+        for(j=i; j && (linePosition[j-1] > position); j--) {
+            linePosition[j] = linePosition[j-1];
+            lineCode[j] = lineCode[j-1];
+        }
+        linePosition[j] = position;
+        lineCode[j] = code;
+    }
+
+    left = (uSpaceCount > linePosition[0]) ? uSpaceCount-linePosition[0] : linePosition[0]-uSpaceCount;
+    right = (uSpaceCount > linePosition[lineCount-1]) ? uSpaceCount-linePosition[lineCount-1] : linePosition[lineCount-1]-uSpaceCount;
+
+    rightToLeft = (left > right);                           // start from the nearer end
+    if (strikeOrdering && (ww_print_line_ordered(FALSE) < ww_passes_cost(rightToLeft))) {
+        ww_print_line_ordered(TRUE);
+    }
+    else {
+        ww_print_pass(rightToLeft,FALSE);                   // the letters...
+        ww_print_pass(!rightToLeft,TRUE);                   // then the underscores on the way back
+    }
+    lineCount = 0;
+}
+
+//------------------------------------------------------------------------------------------------
+// prints whatever is in the line buffer and moves the carrier and paper to where the next character
+// will print. called when the host stops sending and after keystrokes in 'local' mode so that the
+// carrier is where the typist expects it to be.
+//------------------------------------------------------------------------------------------------
+void ww_flush(void) {
+    ww_print_line();
+    ww_move_carrier(uSpaceTarget);
+    ww_move_paper();
+}
+
+//------------------------------------------------------------------------------------------------
+// called when the host has stopped sending. prints any partial line in the line buffer and moves
+// the carrier and paper to where the next character will print, as ww_flush() does. when line
+// buffering with nothing buffered, the last line has already been printed and only the carriage
+// return is waiting: the carrier is left where it is, since the next line is printed from
+// whichever end is nearer, and only the paper is moved.
+//------------------------------------------------------------------------------------------------
+void ww_idle(void) {
+    if (lineBuffering && !lineCount)
+        ww_move_paper();
+    else
+        ww_flush();
+}
+
+//------------------------------------------------------------------------------------------------
+// turns line buffering and bidirectional printing on or off.
+//------------------------------------------------------------------------------------------------
+void ww_line_buffering(unsigned char on) {
+    ww_flush();                                             // print anything still buffered
+    lineBuffering = on;
+}
+
+//------------------------------------------------------------------------------------------------
+// backspace, no erase. decreases the logical position by uSpacesPerChar.
+//------------------------------------------------------------------------------------------------
+void ww_backspace(void) {
+    if (uSpaceTarget >= uSpacesPerChar)                     // only if not at the left margin
+        uSpaceTarget -= uSpacesPerChar;
+}
+
+//------------------------------------------------------------------------------------------------
+// backspace 1/120 inch. decrements the logical position.
+//------------------------------------------------------------------------------------------------
+void ww_micro_backspace(void) {
+    if (uSpaceTarget)                                       // only if not at the left margin
+        --uSpaceTarget;
+}
+
+//------------------------------------------------------------------------------------------------
+// sets the logical position back to the left margin. the carrier is moved to the left margin
+// by ww_move_carrier() when the next character is struck.
+// When line buffering, the buffered line is printed and the carrier stays where it is; the next
+// line will be printed starting from its right end.
+//------------------------------------------------------------------------------------------------
+void ww_carriage_return(void) {
+    ww_print_line();
+    uSpaceTarget = 0;
+}
+
+//------------------------------------------------------------------------------------------------
+// ww_spins the printwheel as a visual and audible indication
+//------------------------------------------------------------------------------------------------
+void ww_spin(void) {
+    ww_print_line();
+    send_to_printer_board_queued(0x121);
+    send_to_printer_board_queued(0x007);
+}
+
+//------------------------------------------------------------------------------------------------
+// horizontal tab number of "spaces". updates the logical position, no further than the right stop.
+//------------------------------------------------------------------------------------------------
+void ww_horizontal_tab(unsigned char spaces) {
+    unsigned int move = spaces*uSpacesPerChar;              // number of microspaces to move right
+
+    if (uSpaceTarget+move < RIGHTSTOP)                      // only up to the right stop
+        uSpaceTarget += move;
+    else
+        uSpaceTarget = RIGHTSTOP;
+}
+
+//------------------------------------------------------------------------------------------------
+// backspaces and erases "letter". updates micro space count.
+// Note: erasing bold or underlined characters or characters on
+// lines other than the current line is not implemented yet.
+//------------------------------------------------------------------------------------------------
+void ww_erase_letter(unsigned char letter) {
+     ww_flush();
+     send_to_printer_board_queued(0x121);
+     send_to_printer_board_queued(0x006);                // move the carrier horizontally
+     send_to_printer_board_queued(0x000);                // bit 7 is cleared for right to left direction
+     send_to_printer_board_queued(uSpacesPerChar);       // number of micro spaces to move left
+     send_to_printer_board_queued(0x121);
+     send_to_printer_board_queued(0x004);                // print on correction tape
+     send_to_printer_board_queued(ASCII2printwheel[letter-0x20]);
+     send_to_printer_board_queued(uSpacesPerChar);       // number of micro spaces to move right
+     uSpaceCount -= uSpacesPerChar;                      // update the micro space count
+     uSpaceTarget = uSpaceCount;
+}
+
+//------------------------------------------------------------------------------------------------
+// Vertical movement is collected in uLinePending and sent to the Printer Board by ww_move_paper()
+// just before the next character is struck (or when ww_flush() is called) using as few vertical
+// movement commands as possible. uLinePosition keeps track of the print line's position on the
+// page, in micro lines below the top of form, so that form feed is a single large paper move.
+//------------------------------------------------------------------------------------------------
+void ww_vertical(int microlines) {
+    ww_print_line();                                        // buffered characters print on the current line
+    uLinePending += microlines;
+    microlines %= (int)uLinesPerPage;
+    uLinePosition = (uLinePosition+uLinesPerPage+microlines)%uLinesPerPage;
+}
+
+//------------------------------------------------------------------------------------------------
+// sends the pending vertical movement to the Printer Board. bits 0-4 of the 3rd word hold the
+// number of micro lines, so movements of more than 31 micro lines are split into several commands.
+//------------------------------------------------------------------------------------------------
+void ww_move_paper(void) {
+    unsigned char m;
+
+    while (uLinePending) {
+        send_to_printer_board_queued(0x121);
+        send_to_printer_board_queued(0x005);                // vertical movement
+        if (uLinePending > 0) {
+            m = (uLinePending > 0x1F) ? 0x1F : uLinePending;
+            send_to_printer_board_queued(0x080|m);          // bit 7 is set to indicate paper up direction, bits 0-4 indicate number of microlines
+            uLinePending -= m;
+        }
+        else {
+            m = (uLinePending < -0x1F) ? 0x1F : -uLinePending;
+            send_to_printer_board_queued(0x000|m);          // bit 7 is cleared to indicate paper down direction, bits 0-4 indicate number of microlines
+            uLinePending += m;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------
+// paper up one line
+//------------------------------------------------------------------------------------------------
+void ww_linefeed(void) {
+    ww_vertical(uLinesPerLine);
+}
+
+//------------------------------------------------------------------------------------------------
+// paper down one line
+//------------------------------------------------------------------------------------------------
+void ww_reverse_linefeed(void) {
+    ww_vertical(-uLinesPerLine);
+}
+
+//------------------------------------------------------------------------------------------------
+// paper up 1/2 line
+//------------------------------------------------------------------------------------------------
+void ww_paper_up(void) {
+    ww_vertical(uLinesPerLine>>1);
+}
+
+//------------------------------------------------------------------------------------------------
+// paper down 1/2 line
+//------------------------------------------------------------------------------------------------
+void ww_paper_down(void) {
+    ww_vertical(-(uLinesPerLine>>1));
+}
+
+//------------------------------------------------------------------------------------------------
+// paper up 1/8 line (1/48")
+//------------------------------------------------------------------------------------------------
+void ww_micro_up(void) {
+    ww_vertical(uLinesPerLine>>3);
+}
+
+//------------------------------------------------------------------------------------------------
+// paper down 1/8 line (1/48")
+//------------------------------------------------------------------------------------------------
+void ww_micro_down(void) {
+    ww_vertical(-(uLinesPerLine>>3));
+}
+
+//------------------------------------------------------------------------------------------------
+// paper up to the next top of form
+//------------------------------------------------------------------------------------------------
+void ww_form_feed(void) {
+    ww_vertical(uLinesPerPage-uLinePosition);
+}
+
+//------------------------------------------------------------------------------------------------
+// sets the page length to "lines" lines of the current line spacing
+//------------------------------------------------------------------------------------------------
+void ww_page_length(unsigned char lines) {
+    if (lines) {
+        uLinesPerPage = lines*uLinesPerLine;
+        uLinePosition %= uLinesPerPage;
+    }
+}
+
+//------------------------------------------------------------------------------------------------
+// makes the current print line the top of form
+//------------------------------------------------------------------------------------------------
+void ww_top_of_form(void) {
+    uLinePosition = 0;
+}
+
+//-----------------------------------------------------------
+// Sends the printwheel code for the ASCII "letter" to be printed
+// to the printer board on the Wheelwriter.
+// Handles bold, continuous and multiple word underline printing.
+// The carrier is first moved to the logical position, then moves to the right by uSpacesPerChar.
+// Increases the micro space count by uSpacesPerChar for each letter printed.
+// Spaces that are not underlined only advance the logical position.
+// When line buffering, the strikes are put into the line buffer instead.
+//-----------------------------------------------------------
+void ww_print_character(unsigned char letter,unsigned char attribute) {
+     unsigned char code,underline;
+
+     code = ASCII2printwheel[letter-0x20];                // ascii character (-0x20) as index to printwheel table
+     underline = (attribute & ATTR_UNDERLINES) && ((letter!=0x20) || (attribute & ATTR_UNDERLINE));// if underlining AND the letter is not a space OR continuous underlining is on
+     if (lineBuffering) {
+         if (lineCount > LINEBUFSIZE-3) ww_print_line();  // make room for letter, underscore and bold re-strike
+         ww_buffer_strike(uSpaceTarget,code);
+         if (underline)
+             ww_buffer_strike(uSpaceTarget,0x04F);       // '_' underscore
+         if (attribute & ATTR_BOLD)
+             ww_buffer_strike(uSpaceTarget+1,code);      // re-print the character offset by one micro space
+     }
+     else if (code || underline) {
+         ww_move_carrier(uSpaceTarget);                  // one move for any spaces, tabs, backspaces or carriage return since the last strike
+         if (code && underline) {
+             ww_strike(ww_timed(code),0);                // print the letter, advance zero micro spaces
+             code = 0x04F;                               // then print '_' underscore
+         }
+         else if (underline)
+             code = 0x04F;                               // underlined space, print '_' underscore only
+         if ((attribute & ATTR_BOLD) && (ASCII2printwheel[letter-0x20])) {// if the bold bit is set
+             ww_strike(ww_timed(code),1);                // advance carriage by one micro space
+             ww_strike(ww_timed(ASCII2printwheel[letter-0x20]),uSpacesPerChar-1);// re-print the character offset by one micro space, advance carriage the remaining micro spaces
+         }
+         else { // not boldprint
+             ww_strike(ww_timed(code),uSpacesPerChar);
+         }
+     }
+
+     uSpaceTarget += uSpacesPerChar;                     // update the logical position
+     if (uSpaceTarget > RIGHTSTOP) {                     // right stop
+         ww_carriage_return();                           // automatically return to left margin
+         column = 1;
+     }
+}
+
+//--------------------------------------------------------------------------------------------------
+// Decodes the 9 bit words sent by the Wheelwriter Function Board to the Printer Board when keys
+// are pressed and returns the equivalent ASCII character (if there is one). Typically a sequence of a
+// minimum of three words (sometimes more, depending on the key) is required to decode each keypress.
+// Call this function for each word received from the Function Board. Intermediate words return zeros.
+//
+// In 'local' Mode, sends vertical movement commands (Paper Up, Paper Down, Micro Up, Micro
+// Down and SAPI) to the printer board. Vertical movement commands ignored when not in 'local' mode.
+// Horizontal movement commands are returned as Space, Backspace and Tab characters.
+//
+// In passthrough mode the words have already been relayed to the printer board, so nothing is
+// sent; instead the carrier, printwheel and paper positions are updated from the strikes and
+// movements seen so that they are correct when passthrough mode ends.
+//
+// Code key combinations are returned as control keys i.e. Code+C is returned as Control C.
+//
+// The Code+Erase key combo returns 0xF0 which, when seen by the main() function,  is used to toggle between
+// 'line' and 'local' modes.
+//--------------------------------------------------------------------------------------------------
+char ww_decode_keys(unsigned int WWdata) {
+    static unsigned char keystate = 0xFF;
+    static unsigned int lastWWdata = 0;
+    static unsigned int moveHigh = 0;                       // upper 3 bits of a horizontal movement
+    char result;
+
+    result = 0;
+    switch(keystate) {
+        case 0xFF:                                          // waiting for first data word from Wheelwriter...
+            if (WWdata == 0x121)                            // all commands must start with 0x121...
+               keystate = 0xFE;
+            break;
+        case 0xFE:                                          // 0x121 has been received...
+            switch(WWdata) {
+                case 0x003:                                 // 0x121,0x003 is start of alpha-numeric character sequence
+                    keystate = 0x30;
+                    break;
+                case 0x005:                                 // 0x121,0x005 is start of vertical movement sequence
+                    keystate = 0x50;
+                    break;
+                case 0x006:                                 // 0x121,0x006 is start of horizontal movement sequence
+                    keystate = 0x60;
+                    break;
+                case 0x00E:                                 // 0x121,0x00E is the start of a code key sequence
+                    keystate = 0xE0;
+                    break;
+                default:
+                    keystate = 0xFF;                        // anything else
+            } // switch(WWdata)
+            break;
+        case 0x30:                                          // 0x121,0x003 has been received...
+            keystate = 0x31;                                // must wait for the microspaces value to follow
+            break;
+        case 0x31:                                          // 0x121,0x003,printwheel code  has been received, waiting for microspaces...
+            keystate = 0xFF;                                // reset keystate back to start
+            result = printwheel2ASCII[(lastWWdata-1)];      // get the ASCII code from the translation table
+            if (passthrough) {                              // the printer board has struck the character and advanced the carrier
+                if (lastWWdata) wheelPosition = lastWWdata;
+                uSpaceCount += WWdata;
+                uSpaceTarget = uSpaceCount;
+            }
+            break;
+        case 0x50:                                          // 0x121,0x005 has been received, move paper vertically...
+            keystate = 0xFF;
+            if (((WWdata&0x1F)==uLinesPerLine)&&(WWdata&0x80))// one line AND paper up direction
+                result = CR;                                // LF used to detect when C Rtn key is pressed
+            if (passthrough) {                              // the printer board has moved the paper
+                if (WWdata&0x80)
+                    uLinePosition = (uLinePosition+(WWdata&0x1F))%uLinesPerPage;
+                else
+                    uLinePosition = (uLinePosition+uLinesPerPage-(WWdata&0x1F))%uLinesPerPage;
+            }
+            else if (localMode) {                           // if 'local' mode...
+                ww_flush();
+                send_to_printer_board_queued(0x121);        // pass all vertical commands thru...
+                send_to_printer_board_queued(0x005);        // Paper Up, Paper Down, Micro Up, Micro Down and SAPI
+                send_to_printer_board_queued(WWdata);
+                if (WWdata&0x80)                            // keep track of the position on the page
+                    uLinePosition = (uLinePosition+(WWdata&0x1F))%uLinesPerPage;
+                else
+                    uLinePosition = (uLinePosition+uLinesPerPage-(WWdata&0x1F))%uLinesPerPage;
+            }
+            break;
+        case 0x60:                                          // 0x121,0x006 has been received...
+            moveHigh = (WWdata&0x007)<<8;
+            if (WWdata & 0x080)                             // if bit 7 is set...
+               keystate = 0x61;                             // 0x121,0x006,0x080 is horizontal movement to the right...
+            else                                            // else...
+               keystate = 0x62;                             // 0x121,0x006,0x000 is horizontal movement to the left...
+            break;
+        case 0x61:                                          // 0x121,0x006,0x08X has been received, move carrier to the right...
+            keystate = 0xFF;
+            if (passthrough) uSpaceTarget = uSpaceCount = uSpaceCount+(moveHigh|WWdata);
+            if ((WWdata>uSpacesPerChar)&&(WWdata<uSpacesPerChar*10)) // if more than one space but less than 10 spaces, must be horizontal tab
+                result = HT;
+            else if (WWdata==uSpacesPerChar)
+                result = SP;
+            break;
+        case 0x62:                                          // 0x121,0x006,0x00X has been received, move carrier to the left...
+            keystate = 0xFF;
+            if (passthrough) uSpaceTarget = uSpaceCount = uSpaceCount-(moveHigh|WWdata);
+            if (WWdata==uSpacesPerChar)
+                result = BS;
+            break;
+        case 0xE0:                                          // 0x121,0x00E has been received (code key combination)
+            keystate = 0xFF;
+            // convert code key combinations into control keys i.e. code+C is converted into control C
+            switch(WWdata & 0x07F) {                        // bit 7 is cleared on WW3, set on WW6
+                case 0x001:                                 // Code+1
+                    break;
+                case 0x002:                                 // Code+Q
+                    result = DC1;                           // converted to ^Q
+                    break;
+                case 0x004:                                 // Code+A
+                    result = SOH;                           // converted to ^A
+                    break;
+                case 0x006:                                   // Code+Z
+                    result = SUB;                           // converted to ^Z
+                    break;
+                case 0x009:                                 // Code+2
+                    break;
+                case 0x00A:                                 // Code+W
+                    result = ETB;                           // converted to ^W
+                    break;
+                case 0x00C:                                 // Code+S
+                    result = DC3;                           // converted to ^S
+                    break;
+                case 0x00E:                                 // Code+X
+                    result = CAN;                           // converted to ^X
+                    break;
+                case 0x011:                                 // Code+3
+                    break;
+                case 0x012:                                 // Code+E
+                    result = ENQ;                           // converted to ^E
+                    break;
+                case 0x014:                                 // Code+D
+                    result = EOT;                           // converted to ^D
+                    break;
+                case 0x016:                                   // Code+C
+                    result = ETX;                           // converted to ^C
+                    break;
+                case 0x018:                                 // Code+5
+                    break;
+                case 0x019:                                 // Code+4
+                    break;
+                case 0x01A:                                 // Code+R
+                    result = DC2;                           // converted to ^R
+                    break;
+                case 0x01B:                                 // Code+T
+                    result = DC4;                           // converted to ^T
+                    break;
+                case 0x01C:                                 // Code+F
+                    result = ACK;                           // converted to ^F
+                    break;
+                case 0x01D:                                   // Code+G
+                    result = BEL;                           // converted to ^G
+                    break;
+                case 0x01E:                                 // Code+V
+                    result = SYN;                           // converted to ^V
+                    break;
+                case 0x01F:                                 // Code+B
+                    result = STX;                           // converted to ^B
+                    break;
+                case 0x020:                                 // Code+6
+                    break;
+                case 0x021:                                 // Code+7
+                    break;
+                case 0x022:                                 // Code+U
+                    result = NAK;                           // converted to ^U
+                    break;
+                case 0x023:                                 // Code+Y
+                    result = EM;                            // converted to ^Y
+                    break;
+                case 0x024:                                   // Code+J
+                    result = LF;                            // converted to ^J
+                    break;
+                case 0x025:                                   // Code+H
+                    result = BS;                            // converted to ^H
+                    break;
+                case 0x026:                                   // Code+M
+                    result = CR;                            // converted to ^M
+                    break;
+                case 0x029:                                 // Code+8
+                    break;
+                case 0x02A:                                   // Code+I
+                    result = HT;                            // converted to ^I
+                    break;
+                case 0x02C:                                   // Code+K
+                    result = VT;                            // converted to ^K
+                    break;
+                case 0x031:                                 // Code+9
+                    break;
+                case 0x032:                                 // Code+O
+                    result = SI;                            // converted to ^O
+                    break;
+                case 0x034:                                   // Code+L
+                    result = FF;                            // converted to ^L
+                    break;
+                case 0x039:                                 // Code+0
+                    break;
+                case 0x03A:                                 // Code+P
+                    result = DLE;                           // converted to ^P
+                    break;
+                case 0x042:                                 // Code+L Mar
+                    break;
+                case 0x045:                                 // Code+T Clr
+                    break;
+                case 0x046:                                 // Code+Micro Dn
+                    break;
+                case 0x047:                                 // Code+Space
+                    break;
+                case 0x048:                                 // Code+Mar Rel
+                    result = ESC;                           // converted to Escape
+                    break;
+                case 0x04A:                                 // Code+Tab
+                    break;
+                case 0x04B:                                 // Code+R Mar
+                    break;
+                case 0x04C:                                 // Code+T Set
+                    break;
+                case 0x4F:                                  // Code+Erase
+                    result = 0xF0;                          // return 0xF0 for Code+Erase key combo to toggle line/local mode flag
+                    break;
+                case 0x051:                                 // Code+Paper Up
+                    break;
+                case 0x052:                                 // Code+Paper Dn
+                    break;
+                case 0x054:                                 // Code+Micro Up
+                    break;
+                case 0x056:                                 // Code+C Rtn
+                    break;
+                case 0x057:                                 // Code+Line Space
+                    break;
+                case 0x067:                                 // code key released
+                    break;
+                case 0x076:                                 // Code+N
+                    result = SO;                            // converted to ^N
+                    break;
+            } // switch(WWdata & 0x17F)
+            break;
+    }   // switch(keystate)
+    lastWWdata = WWdata;                                    // save for next time
+    return(result);
+}
+
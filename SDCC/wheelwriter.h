@@ -1,24 +1,52 @@
-// for the Small Device C Compiler (SDCC)
-
-#ifndef __WHEELWRITER_H__
-#define __WHEELWRITER_H__
-
-void ww_print_character(unsigned char letter,unsigned char attribute);
-void ww_backspace(void);                        
-void ww_micro_backspace(void);
-void ww_space(void);
-void ww_carriage_return(void);
-void ww_spin(void);
-void ww_horizontal_tab(unsigned char spaces);
-void ww_erase_letter(unsigned char letter);
-void ww_linefeed(void);
-void ww_reverse_linefeed(void);
-void ww_paper_up(void);                    
-void ww_paper_down(void);
-void ww_micro_up(void);
-void ww_micro_down(void);
-char ww_decode_keys(unsigned int WWdata);
-void ww_reset(char board);
-
-#endif
-
+// for the Small Device C Compiler (SDCC)
+
+#ifndef __WHEELWRITER_H__
+#define __WHEELWRITER_H__
+
+#define ATTR_BOLD       0x01            // each letter struck twice, the second time one micro space to the right
+#define ATTR_UNDERLINE  0x02            // continuous underline, spaces between words are underlined too
+#define ATTR_WORDS      0x04            // broken underline, only the letters are underlined
+#define ATTR_UNDERLINES (ATTR_UNDERLINE|ATTR_WORDS) // either kind of underlining
+
+void ww_print_character(unsigned char letter,unsigned char attribute);
+void ww_move_carrier(unsigned int position);
+void ww_strike(unsigned char code,unsigned char advance);
+unsigned char ww_timed(unsigned char code);
+void ww_time_strikes(unsigned char on);
+unsigned char ww_strikes_timed(void);
+void ww_init(void);
+void ww_cost_model(unsigned char settle,unsigned char perSpoke,unsigned char start,unsigned char move);
+unsigned char ww_wheel_distance(unsigned char code1,unsigned char code2);
+void ww_line_strike(unsigned int position,unsigned char code,unsigned int next);
+unsigned int ww_strike_cost(unsigned int position,unsigned char wheel,unsigned char i);
+unsigned int ww_end_cost(unsigned int position);
+unsigned long ww_print_line_ordered(unsigned char strike);
+unsigned long ww_passes_cost(unsigned char rightToLeft);
+void ww_print_pass(unsigned char rightToLeft,unsigned char underscores);
+void ww_print_line(void);
+void ww_flush(void);
+void ww_idle(void);
+void ww_line_buffering(unsigned char on);
+void ww_backspace(void);                        
+void ww_micro_backspace(void);
+void ww_space(void);
+void ww_carriage_return(void);
+void ww_spin(void);
+void ww_horizontal_tab(unsigned char spaces);
+void ww_erase_letter(unsigned char letter);
+void ww_linefeed(void);
+void ww_reverse_linefeed(void);
+void ww_paper_up(void);                    
+void ww_paper_down(void);
+void ww_micro_up(void);
+void ww_micro_down(void);
+void ww_vertical(int microlines);
+void ww_move_paper(void);
+void ww_form_feed(void);
+void ww_page_length(unsigned char lines);
+void ww_top_of_form(void);
+char ww_decode_keys(unsigned int WWdata);
+void ww_reset(unsigned char board);
+
+#endif
+
@@ -1,132 +1,196 @@
-//************************************************************************//
-// UART3 functions for connecting with the Wheelwriter Function Board     //
-// for the Small Device C Compiler (SDCC)                                 //
-//                                                                        //
-// Interrupt driven UART3 functions. UART3 uses a receive buffer in       //
-// internal MOVX SRAM. UART3 uses the Timer 3 for baud rate generation.   //
-// init_uart3 must be called before using functions. No syntax error      //
-// handling. No handshaking. RxD3 on pin 1, TxD3 on pin 2                 //
-//************************************************************************//
-
-#include "reg51.h"
-#include "stc51.h"
-
-#define FALSE 0
-#define TRUE  1
-
-#define RBUFSIZE3 16                             // must be 128, 64, 32, 16 or 4 bytes
-#if RBUFSIZE3 < 4
-    #error RBUFSIZE3 may not be less than 4.
-#elif RBUFSIZE3 > 128
-    #error RBUFSIZE3 may not be greater than 128.
-#elif ((RBUFSIZE3 & (RBUFSIZE3-1)) != 0)
-    #error RBUFSIZE3 must be a power of 2.
-#endif
-
-volatile unsigned char rx3_head;                  // receive interrupt index for UART3
-volatile unsigned char rx3_tail;                  // receive read index for UART3
-volatile unsigned int __xdata rx3_buf[RBUFSIZE3]; // receive buffer for UART3 1 in internal MOVX RAM
-volatile __bit tx3_ready;                         // set when ready to transmit
-__sbit __at (0x80) WWbus3;                        // P0.0, (RXD3, pin 1) used to monitor the Wheelwriter BUS
-
-// ---------------------------------------------------------------------------
-// UART3 interrupt service routine
-// ---------------------------------------------------------------------------
-void uart3_isr(void) __interrupt(17) __using(3) {
-   unsigned int wwBusData;
-   //static char count = 0;
-
-    // UART3 transmit interrupt
-    if (S3TI) {                                 // transmit interrupt?
-      CLR_S3TI;                                 // clear transmit interrupt flag
-      tx3_ready = TRUE;                         // transmit buffer is ready for a new character
-    }
-
-    if(S3RI) {                                  // receive interrupt?
-       CLR_S3RI;                                // clear receive interrupt flag
-       wwBusData = S3BUF;                       // retrieve the lower 8 bits
-       if (S3RB8) wwBusData |= 0x0100;          // ninth bit is in S3RB8
-       rx3_buf[rx3_head++ & (RBUFSIZE3-1)] = wwBusData;  // save it in the buffer
-    }
-}
-
-// ---------------------------------------------------------------------------
-//  Initialize UART3 for mode 3. Mode 3 is an asynchronous mode that transmits and receives
-//  a total of 11 bits: 1 start bit, 9 data bits, and 1 stop bit. The ninth bit to be
-//  transmitted is determined by the value in S3TB8 (S3CON.3). When the ninth bit is received,
-//  it is stored in S3RB8 (S3CON.2).
-//  The baud rate is determined by the T3 overflow rate.
-//  the formula for calculating the UART3 baud rate is: baud rate = (T3 overflow)/4.
-//  If T3 is operating in 1T mode (T3x12=1), the baud rate of UART3 = SYSclk/(65536-[T3H,T3L])/4.
-//  In this case, the baud rate is: 12,000,000/(65526-65520)/4 = 187500 bps.
-// ---------------------------------------------------------------------------
-void uart3_init(void) {
-    rx3_head = 0;                               // initialize UART3 buffer head/tail pointers.
-    rx3_tail = 0;
-
-    SET_S3ST3;                                  // set S3ST3 to select Timer 3 as baud rate generator for UART3.
-    CLR_T3_CT;                                  // clear T3_C/T to make Timer 3 operate as timer instead of counter
-    SET_T3x12;                                  // set T3x12=1 to make Timer 3 operate in 1T mode.
-    T3L = 0XF0;                                 // low byte of 65520
-    T3H = 0XFF;                                 // high byte of 65520
-    SET_T3R;                                    // set T3R to enable Timer 3 to run
-
-    SET_S3SM0;                                  // set S3SM0 for UART3 mode 3 operation
-    SET_S3REN;                                  // set S3REN to enable reception
-    SET_S3TI;                                   // set S3TI to enable transmit
-    CLR_S3RI;                                   // clear S3RI
-    SET_ES3;                                    // set ES3 to enable UART3 serial interrupt
-    EA = TRUE;                                  // enable global interrupt
-}
-
-// ---------------------------------------------------------------------------
-// sends Acknowledge (all zeros) to the Function Board
-// ---------------------------------------------------------------------------
-void send_ACK_to_function_board(void) {
-   while (!tx3_ready);                          // wait until transmit buffer is empty
-   tx3_ready = 0;                               // clear flag
-   while(!WWbus3);                              // wait until the Wheelwriter bus goes high
-   CLR_S3REN;                                   // clear S3REN to disable reception
-   CLR_S3TB8;                                   // clear 9th bit
-   S3BUF = 0x00;                                // clear lower 8 bits
-   while(!tx3_ready);                           // wait until finished transmitting
-   while(!WWbus3);                              // wait until the Wheelwriter bus goes high
-   SET_S3REN;                                   // set S3REN to re-enable reception
-}
-
-// ---------------------------------------------------------------------------
-// sends an unsigned integer as 11 bits (start bit, 9 data bits, stop bit)
-// to the Function Board. does not wait for acknowledge
-// ---------------------------------------------------------------------------
-void send_to_function_board(unsigned int wwCommand) {
-   while (!tx3_ready);                          // wait until transmit buffer is empty
-   tx3_ready = 0;                               // clear flag
-   while(!WWbus3);                              // wait until the Wheelwriter bus goes high
-   CLR_S3REN;                                   // clear S3REN to disable reception
-   if (wwCommand & 0x100) SET_S3TB8; else CLR_S3TB8; // 9th bit
-   S3BUF = wwCommand & 0xFF;                    // lower 8 bits
-   while(!tx3_ready);                           // wait until finished transmitting
-   while(!WWbus3);                              // wait until the Wheelwriter bus goes high
-   SET_S3REN;                                   // set S3REN to re-enable reception
-}
-
-// ---------------------------------------------------------------------------
-// returns 1 if there is an unsigned integer from the Function Board waiting in the UART3 receive buffer.
-// ---------------------------------------------------------------------------
-char function_board_cmd_avail(void) {
-   return (rx3_head != rx3_tail);               // not equal means there's something in the buffer
-}
-
-//----------------------------------------------------------------------------
-// returns the next unsigned integer from the Function Board in the UART3 receive buffer.
-// waits for an integer to become available if necessary.
-//----------------------------------------------------------------------------
-unsigned int get_function_board_cmd(void) {
-    unsigned int buf;
-
-    while (rx3_head == rx3_tail);               // wait until a word is available
-    buf = rx3_buf[rx3_tail++ & (RBUFSIZE3-1)];  // retrieve the word from the buffer
-    return(buf);
-}
-
-
+//************************************************************************//
+// UART3 functions for connecting with the Wheelwriter Function Board     //
+// for the Small Device C Compiler (SDCC)                                 //
+//                                                                        //
+// Interrupt driven UART3 functions. UART3 uses a receive buffer in       //
+// internal MOVX SRAM. UART3 uses the Timer 3 for baud rate generation.   //
+// init_uart3 must be called before using functions. No syntax error      //
+// handling. No handshaking. RxD3 on pin 1, TxD3 on pin 2                 //
+// Once enabled, the Acknowledge for each word received from the Function //
+// Board is sent by the ISR so that it does not wait for the main loop.   //
+//************************************************************************//
+
+#include <stdio.h>
+#include "reg51.h"
+#include "stc51.h"
+#include "trace.h"
+
+#define FALSE 0
+#define TRUE  1
+
+#define BUSPOLLS 255                             // polls of the bus, about 170 microseconds, before the ISR gives up waiting for it
+#define RBUFSIZE3 16                             // must be 128, 64, 32, 16 or 4 bytes
+#if RBUFSIZE3 < 4
+    #error RBUFSIZE3 may not be less than 4.
+#elif RBUFSIZE3 > 128
+    #error RBUFSIZE3 may not be greater than 128.
+#elif ((RBUFSIZE3 & (RBUFSIZE3-1)) != 0)
+    #error RBUFSIZE3 must be a power of 2.
+#endif
+
+volatile unsigned char rx3_head;                  // receive interrupt index for UART3
+volatile unsigned char rx3_tail;                  // receive read index for UART3
+volatile unsigned int __xdata rx3_buf[RBUFSIZE3]; // receive buffer for UART3 1 in internal MOVX RAM
+volatile __bit tx3_ready;                         // set when ready to transmit
+volatile __bit tx3_ack;                           // set while the ISR is sending an Acknowledge
+volatile __bit ack3_pending;                      // set when a word is waiting for its Acknowledge
+__bit ack3;                                       // when set, the ISR acknowledges each word from the Function Board
+volatile unsigned int __xdata rx3_overruns;       // words lost because the receive buffer was full
+volatile unsigned char __xdata rx3_highWater;     // most words waiting in the receive buffer at once
+volatile unsigned long __xdata rx3_total;         // words received
+extern __bit errorLED;                            // defined in main.c
+__sbit __at (0x80) WWbus3;                        // P0.0, (RXD3, pin 1) used to monitor the Wheelwriter BUS
+
+// ---------------------------------------------------------------------------
+// waits for the Wheelwriter bus to go high, for no more than BUSPOLLS polls.
+// used in the ISR so that a bus held low can't hold off the other ISRs.
+// busPolls is left at 0 if the bus is still low.
+// ---------------------------------------------------------------------------
+#define WAIT_WWBUS3                                                            \
+    busPolls = BUSPOLLS;                                                       \
+    while (!WWbus3 && --busPolls)
+
+// ---------------------------------------------------------------------------
+// UART3 interrupt service routine
+// ---------------------------------------------------------------------------
+void uart3_isr(void) __interrupt(17) __using(3) {
+   unsigned int wwBusData;
+   unsigned char busPolls;
+
+    // UART3 transmit interrupt
+    if (S3TI) {                                 // transmit interrupt?
+      CLR_S3TI;                                 // clear transmit interrupt flag
+      tx3_ready = TRUE;                         // transmit buffer is ready for a new character
+      if (tx3_ack) {                            // if the Acknowledge has been sent...
+         tx3_ack = FALSE;
+         WAIT_WWBUS3;                           // wait until the Wheelwriter bus goes high
+         SET_S3REN;                             // set S3REN to re-enable reception
+      }
+    }
+
+    if(S3RI) {                                  // receive interrupt?
+       CLR_S3RI;                                // clear receive interrupt flag
+       wwBusData = S3BUF;                       // retrieve the lower 8 bits
+       if (S3RB8) wwBusData |= 0x0100;          // ninth bit is in S3RB8
+       TRACE(TRACE_FB,wwBusData);
+       ++rx3_total;
+       if ((unsigned char)(rx3_head-rx3_tail) != RBUFSIZE3) { // unless the buffer is full...
+          rx3_buf[rx3_head++ & (RBUFSIZE3-1)] = wwBusData;  // save it in the buffer
+          if ((unsigned char)(rx3_head-rx3_tail) > rx3_highWater) rx3_highWater = rx3_head-rx3_tail;
+       }
+       else {
+          ++rx3_overruns;                       // the word is lost
+          errorLED = TRUE;
+       }
+       if (ack3) ack3_pending = TRUE;           // mimic the Printer Board by acknowledging the word
+    }
+
+    // the Acknowledge is sent as soon as the transmitter is free and the bus is
+    // high. if the bus stays low it's tried again at the next UART3 interrupt.
+    if (ack3_pending && tx3_ready) {
+       WAIT_WWBUS3;                             // wait until the Wheelwriter bus goes high
+       if (busPolls) {
+          ack3_pending = FALSE;
+          tx3_ready = FALSE;
+          tx3_ack = TRUE;
+          CLR_S3REN;                            // clear S3REN to disable reception
+          CLR_S3TB8;                            // clear 9th bit
+          S3BUF = 0x00;                         // clear lower 8 bits
+          TRACE(TRACE_TOFB,0);
+       }
+    }
+}
+
+// ---------------------------------------------------------------------------
+//  Initialize UART3 for mode 3. Mode 3 is an asynchronous mode that transmits and receives
+//  a total of 11 bits: 1 start bit, 9 data bits, and 1 stop bit. The ninth bit to be
+//  transmitted is determined by the value in S3TB8 (S3CON.3). When the ninth bit is received,
+//  it is stored in S3RB8 (S3CON.2).
+//  The baud rate is determined by the T3 overflow rate.
+//  the formula for calculating the UART3 baud rate is: baud rate = (T3 overflow)/4.
+//  If T3 is operating in 1T mode (T3x12=1), the baud rate of UART3 = SYSclk/(65536-[T3H,T3L])/4.
+//  In this case, the baud rate is: 12,000,000/(65526-65520)/4 = 187500 bps.
+// ---------------------------------------------------------------------------
+void uart3_init(void) {
+    rx3_head = 0;                               // initialize UART3 buffer head/tail pointers.
+    rx3_tail = 0;
+    tx3_ack = FALSE;
+    ack3_pending = FALSE;
+    ack3 = FALSE;                               // words are relayed to the Printer Board during initialization
+
+    SET_S3ST3;                                  // set S3ST3 to select Timer 3 as baud rate generator for UART3.
+    CLR_T3_CT;                                  // clear T3_C/T to make Timer 3 operate as timer instead of counter
+    SET_T3x12;                                  // set T3x12=1 to make Timer 3 operate in 1T mode.
+    T3L = 0XF0;                                 // low byte of 65520
+    T3H = 0XFF;                                 // high byte of 65520
+    SET_T3R;                                    // set T3R to enable Timer 3 to run
+
+    SET_S3SM0;                                  // set S3SM0 for UART3 mode 3 operation
+    SET_S3REN;                                  // set S3REN to enable reception
+    SET_S3TI;                                   // set S3TI to enable transmit
+    CLR_S3RI;                                   // clear S3RI
+    SET_ES3;                                    // set ES3 to enable UART3 serial interrupt
+    EA = TRUE;                                  // enable global interrupt
+}
+
+// ---------------------------------------------------------------------------
+// when 'on' is TRUE, the ISR sends the Acknowledge for each word it receives
+// from the Function Board. when FALSE, the words are acknowledged by the
+// Printer Board (relayed by the main program)
+// ---------------------------------------------------------------------------
+void function_board_ack(unsigned char on) {
+   ack3 = on;
+}
+
+// ---------------------------------------------------------------------------
+// sends an unsigned integer as 11 bits (start bit, 9 data bits, stop bit)
+// to the Function Board. does not wait for acknowledge
+// ---------------------------------------------------------------------------
+void send_to_function_board(unsigned int wwCommand) {
+   while (!tx3_ready);                          // wait until transmit buffer is empty
+   tx3_ready = 0;                               // clear flag
+   while(!WWbus3);                              // wait until the Wheelwriter bus goes high
+   CLR_S3REN;                                   // clear S3REN to disable reception
+   if (wwCommand & 0x100) SET_S3TB8; else CLR_S3TB8; // 9th bit
+   S3BUF = wwCommand & 0xFF;                    // lower 8 bits
+   TRACE(TRACE_TOFB,wwCommand);
+   while(!tx3_ready);                           // wait until finished transmitting
+   while(!WWbus3);                              // wait until the Wheelwriter bus goes high
+   SET_S3REN;                                   // set S3REN to re-enable reception
+}
+
+// ---------------------------------------------------------------------------
+// returns 1 if there is an unsigned integer from the Function Board waiting in the UART3 receive buffer.
+// ---------------------------------------------------------------------------
+char function_board_cmd_avail(void) {
+   return (rx3_head != rx3_tail);               // not equal means there's something in the buffer
+}
+
+//----------------------------------------------------------------------------
+// returns the next unsigned integer from the Function Board in the UART3 receive buffer.
+// waits for an integer to become available if necessary.
+//----------------------------------------------------------------------------
+unsigned int get_function_board_cmd(void) {
+    unsigned int buf;
+
+    while (rx3_head == rx3_tail);               // wait until a word is available
+    buf = rx3_buf[rx3_tail++ & (RBUFSIZE3-1)];  // retrieve the word from the buffer
+    return(buf);
+}
+
+// ---------------------------------------------------------------------------
+// prints the UART3 receive buffer statistics on one line: the buffer size,
+// the most words ever waiting, the words lost and received
+// ---------------------------------------------------------------------------
+void uart3_stats(void) {
+    unsigned int overruns;
+    unsigned char highWater;
+    unsigned long total;
+
+    CLR_ES3;
+    overruns = rx3_overruns;
+    highWater = rx3_highWater;
+    total = rx3_total;
+    SET_ES3;
+    printf("%-12s %5u %10u %9u %11lu\n","UART3 FB",RBUFSIZE3,(int)highWater,overruns,total);
+}
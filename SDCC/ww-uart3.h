@@ -1,14 +1,19 @@
-// for the Small Device C Compiler (SDCC)
-
-#ifndef __UART3_H__
-#define __UART3_H__
-
-void uart3_isr(void) __interrupt(17) __using(3);
-void uart3_init(void);
-void send_ACK_to_function_board(void);
-void send_to_function_board(unsigned int wwCommand);
-char function_board_cmd_avail(void);
-unsigned int get_function_board_cmd(void);
-
-#endif
-
+// for the Small Device C Compiler (SDCC)
+
+#ifndef __UART3_H__
+#define __UART3_H__
+
+void uart3_isr(void) __interrupt(17) __using(3);
+void uart3_init(void);
+void function_board_ack(unsigned char on);
+void send_to_function_board(unsigned int wwCommand);
+char function_board_cmd_avail(void);
+unsigned int get_function_board_cmd(void);
+void uart3_stats(void);
+
+extern volatile unsigned int __xdata rx3_overruns;
+extern volatile unsigned char __xdata rx3_highWater;
+extern volatile unsigned long __xdata rx3_total;
+
+#endif
+
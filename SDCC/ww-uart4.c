@@ -1,133 +1,311 @@
-//************************************************************************//
-// UART4 functions for connecting with the Wheelwriter Printer Board      //
-// for the Small Device C Compiler (SDCC)                                 //
-//                                                                        //
-// Interrupt driven UART4 functions. UART4 uses a receive buffer in       //
-// internal MOVX SRAM. UART4 uses the Timer 4 for baud rate generation.   //
-// init_uart4 must be called before using functions. No syntax error      //
-// handling. No handshaking. RxD4 on pin 3, TxD4 on pin 4                 //
-//************************************************************************//
-
-#include "reg51.h"
-#include "stc51.h"
-
-#define FALSE 0
-#define TRUE  1
-
-#define RBUFSIZE4 16                            // must be 128, 64, 32, 16 or 4 bytes
-#if RBUFSIZE4 < 4
-    #error RBUFSIZE4 may not be less than 4.
-#elif RBUFSIZE4 > 128
-    #error RBUFSIZE4 may not be greater than 128.
-#elif ((RBUFSIZE4 & (RBUFSIZE4-1)) != 0)
-    #error RBUFSIZE4 must be a power of 2.
-#endif
-
-volatile unsigned char rx4_head;                  // receive interrupt index for UART4
-volatile unsigned char rx4_tail;                  // receive read index for UART4
-volatile unsigned int __xdata rx4_buf[RBUFSIZE4]; // receive buffer for UART4 in internal MOVX RAM
-volatile __bit tx4_ready;                         // set when ready to transmit
-__sbit __at (0x82) WWbus4;                        // P0.2, (RXD4, pin 3) used to monitor the Wheelwriter BUS
-
-// ---------------------------------------------------------------------------
-// UART4 interrupt service routine
-// ---------------------------------------------------------------------------
-void uart4_isr(void) __interrupt(18) __using(3) {
-   unsigned int wwBusData;
-
-    // UART4 transmit interrupt
-    if (S4TI) {                                 // transmit interrupt?
-      CLR_S4TI;                                 // clear transmit interrupt flag
-      tx4_ready = TRUE;                         // transmit buffer is ready for a new character
-    }
-
-    if(S4RI) {                                  // receive interrupt?
-       CLR_S4RI;                                // clear receive interrupt flag
-       wwBusData = S4BUF;                       // retrieve the lower 8 bits
-       if (S4RB8) wwBusData |= 0x0100;          // ninth bit is in S3RB8
-       rx4_buf[rx4_head++ & (RBUFSIZE4-1)] = wwBusData;  // save it in the buffer
-    }
-}
-
-// ---------------------------------------------------------------------------
-//  Initialize UART4 for mode 3. Mode 3 is an asynchronous mode that transmits and receives
-//  a total of 11 bits: 1 start bit, 9 data bits, and 1 stop bit. The ninth bit to be
-//  transmitted is determined by the value in S4TB8 (S4CON.3). When the ninth bit is received,
-//  it is stored in S4RB8 (S4CON.2). The baud rate is determined by the T4 overflow rate.
-//  The formula for calculating the UART4 baud rate is: baud rate = (T4 overflow)/4.
-//  If T4 is operating in 1T mode (T4x12=1), the baud rate of UART4 = SYSclk/(65536-[T4H,T4L])/4.
-//  In this case, the baud rate is: 12,000,000/(65526-65520)/4 = 187500 bps.
-// ---------------------------------------------------------------------------
-void uart4_init(void) {
-    rx4_head = 0;                               // initialize UART4 buffer head/tail pointers.
-    rx4_tail = 0;
-
-    SET_S4ST4;                                  // set S4ST4 to select Timer 4 as baud rate generator for UART3.
-    CLR_T4_CT;                                  // clear T2_C/T to make Timer 2 operate as timer instead of counter
-    SET_T4x12;                                  // set T2x12=1 to make Timer 2 operate in 1T mode.
-    T4L = 0XF0;                                 // the baud rate of UART3 = 12MHz/(65536-65520)/4 = 187500 bps
-    T4H = 0XFF;
-    SET_T4R;                                    // set T2R to enable Timer 2 to run
-
-    SET_S4SM0;                                  // set S4SM0 for mode 3
-    SET_S4REN;                                  // set S4REN to enable reception
-    SET_S4TI;                                   // set S4TI to enable transmit
-    CLR_S4RI;                                   // clear S4RI
-    SET_ES4;                                    // set ES4 to enable UART4 serial interrupt
-    EA = TRUE;                                  // enable global interrupt
-}
-
-// ---------------------------------------------------------------------------
-// sends an unsigned integer as 11 bits (start bit, 9 data bits, stop bit)
-// to the Printer Board. waits for acknowledge from printer board.
-// ---------------------------------------------------------------------------
-void send_to_printer_board_wait(unsigned int wwCommand) {
-   while (!tx4_ready);                          // wait until transmit buffer is empty
-   tx4_ready = 0;                               // clear flag
-   while(!WWbus4);                              // wait until the Wheelwriter bus goes high
-   CLR_S4REN;                                   // clear S4REN to disable reception
-   if (wwCommand & 0x100) SET_S4TB8; else CLR_S4TB8; // 9th bit
-   S4BUF = wwCommand & 0xFF;                    // lower 8 bits
-   while(!tx4_ready);                           // wait until finished transmitting
-   while(!WWbus4);                              // wait until the Wheelwriter bus goes high
-   while(WWbus4);                               // wait until the Wheelwriter bus goes low (acknowledge)
-   while(!WWbus4);                              // wait until the Wheelwriter bus goes high again
-   SET_S4REN;                                   // set S4REN to re-enable reception
-}
-
-// ---------------------------------------------------------------------------
-// sends an unsigned integer as 11 bits (start bit, 9 data bits, stop bit)
-// to the Printer Board. does not wait for acknowledge from printer board.
-// ---------------------------------------------------------------------------
-void send_to_printer_board(unsigned int wwCommand) {
-   while (!tx4_ready);                          // wait until transmit buffer is empty
-   tx4_ready = 0;                               // clear flag
-   while(!WWbus4);                              // wait until the Wheelwriter bus goes high
-   CLR_S4REN;                                   // clear S4REN to disable reception
-   if (wwCommand & 0x100) SET_S4TB8; else CLR_S4TB8; // 9th bit
-   S4BUF = wwCommand & 0xFF;                    // lower 8 bits
-   while(!tx4_ready);                           // wait until finished transmitting
-   while(!WWbus4);                              // wait until the Wheelwriter bus goes high
-   SET_S4REN;                                   // set S4REN to re-enable reception
-}
-
-// ---------------------------------------------------------------------------
-// returns 1 if there is an unsigned integer from the Printer Board waiting in the UART4 receive buffer.
-// ---------------------------------------------------------------------------
-char printer_board_reply_avail(void) {
-   return (rx4_head != rx4_tail);               // not equal means there's something in the buffer
-}
-
-//----------------------------------------------------------------------------
-// returns the next unsigned integer from the Printer Board in the UART4 receive buffer.
-// waits for an integer to become available if necessary.
-//----------------------------------------------------------------------------
-unsigned int get_printer_board_reply(void) {
-    unsigned int buf;
-
-    while (rx4_head == rx4_tail);               // wait until a word is available
-    buf = rx4_buf[rx4_tail++ & (RBUFSIZE4-1)];  // retrieve the word from the buffer
-    return(buf);
-}
-
-
+//************************************************************************//
+// UART4 functions for connecting with the Wheelwriter Printer Board      //
+// for the Small Device C Compiler (SDCC)                                 //
+//                                                                        //
+// Interrupt driven UART4 functions. UART4 uses a receive buffer and a    //
+// command queue in internal MOVX SRAM. Commands in the queue are sent    //
+// one word at a time by the UART4 ISR, each one after the Printer Board  //
+// acknowledges the previous word. UART4 uses the Timer 4 for baud rate   //
+// generation. init_uart4 must be called before using functions. No       //
+// syntax error handling. No handshaking. RxD4 on pin 3, TxD4 on pin 4    //
+//************************************************************************//
+
+#include <stdio.h>
+#include "reg51.h"
+#include "stc51.h"
+#include "trace.h"
+#include "profile.h"
+#include "latency.h"
+#include "ww-uart4.h"
+
+#define FALSE 0
+#define TRUE  1
+
+#define BUSPOLLS4 255                           // polls of the bus, about 170 microseconds, before a queued word is left waiting for it
+#define RBUFSIZE4 16                            // must be 128, 64, 32, 16 or 4 bytes
+#if RBUFSIZE4 < 4
+    #error RBUFSIZE4 may not be less than 4.
+#elif RBUFSIZE4 > 128
+    #error RBUFSIZE4 may not be greater than 128.
+#elif ((RBUFSIZE4 & (RBUFSIZE4-1)) != 0)
+    #error RBUFSIZE4 must be a power of 2.
+#endif
+
+#define TBUFSIZE4 64                            // must be 128, 64, 32, 16 or 4 words
+#if TBUFSIZE4 < 4
+    #error TBUFSIZE4 may not be less than 4.
+#elif TBUFSIZE4 > 128
+    #error TBUFSIZE4 may not be greater than 128.
+#elif ((TBUFSIZE4 & (TBUFSIZE4-1)) != 0)
+    #error TBUFSIZE4 must be a power of 2.
+#endif
+
+#define TX4_IDLE    0                           // no queued word in progress
+#define TX4_SENDING 1                           // a queued word is being shifted out
+#define TX4_ACK     2                           // waiting for the Printer Board to acknowledge the word
+
+#define ON 0                                    // 0 turns the amber LED on
+#define OFF 1                                   // 1 turns the amber LED off
+
+volatile unsigned char rx4_head;                  // receive interrupt index for UART4
+volatile unsigned char rx4_tail;                  // receive read index for UART4
+volatile unsigned int __xdata rx4_buf[RBUFSIZE4]; // receive buffer for UART4 in internal MOVX RAM
+volatile unsigned char tx4_head;                  // index used to fill the command queue
+volatile unsigned char tx4_tail;                  // index used to empty the command queue
+volatile unsigned int __xdata tx4_buf[TBUFSIZE4]; // command queue for the Printer Board in internal MOVX RAM
+volatile unsigned char tx4_state;                 // TX4_IDLE, TX4_SENDING or TX4_ACK
+volatile unsigned int __xdata tx4_word;           // the queued word being sent or waiting for its acknowledge
+volatile __bit tx4_ready;                         // set when ready to transmit
+__bit tx4_stalled;                                // set while the queue waits for the bus to go high
+__sbit __at (0x82) WWbus4;                        // P0.2, (RXD4, pin 3) used to monitor the Wheelwriter BUS
+__sbit __at (0x86) amberLED;                      // amber LED connected to pin 7 0=on, 1=off
+volatile unsigned long __xdata words4;            // words put in the command queue
+volatile __bit ackTiming = FALSE;                 // acknowledge wait statistics are kept while set
+volatile unsigned long __xdata ack4_count;        // acknowledges timed
+volatile unsigned long __xdata ack4_total;        // sum of the acknowledge waits in microseconds
+volatile unsigned long __xdata ack4_max;          // longest acknowledge wait in microseconds
+unsigned long __xdata ack4_start;                 // when the word being acknowledged finished sending
+volatile unsigned int __xdata rx4_overruns;       // words lost because the receive buffer was full
+volatile unsigned char __xdata rx4_highWater;     // most words waiting in the receive buffer at once
+volatile unsigned long __xdata rx4_total;         // words received
+volatile unsigned int __xdata bus4_stalls;        // times the bus stayed low when the queue was to be started
+extern __bit errorLED;                            // defined in main.c
+
+// ---------------------------------------------------------------------------
+// starts shifting out the next word in the command queue. used by the UART4
+// ISR and, with the UART4 interrupt disabled, by tx4_start().
+// the amber LED is on while the Printer Board has commands to process.
+// ---------------------------------------------------------------------------
+#define TX4_START_NEXT                                                         \
+    if (tx4_head != tx4_tail) {                                                \
+        wwBusData = tx4_buf[tx4_tail++ & (TBUFSIZE4-1)];                       \
+        tx4_word = wwBusData;                /* its slot may be reused  */     \
+        CLR_S4REN;                           /* disable reception       */     \
+        if (wwBusData & 0x100) SET_S4TB8; else CLR_S4TB8; /* 9th bit    */     \
+        S4BUF = wwBusData & 0xFF;            /* lower 8 bits            */     \
+        TRACE(TRACE_TOPB,wwBusData);                                           \
+        tx4_state = TX4_SENDING;                                               \
+        amberLED = ON;                                                         \
+    }                                                                          \
+    else {                                                                     \
+        amberLED = OFF;                                                        \
+    }
+
+// ---------------------------------------------------------------------------
+// UART4 interrupt service routine
+// ---------------------------------------------------------------------------
+void uart4_isr(void) __interrupt(18) __using(3) {
+   unsigned int wwBusData;
+   unsigned long wait;
+
+    // UART4 transmit interrupt
+    if (S4TI) {                                 // transmit interrupt?
+      CLR_S4TI;                                 // clear transmit interrupt flag
+      if (tx4_state == TX4_SENDING) {           // if a word from the command queue has been sent...
+         tx4_state = TX4_ACK;                   // wait for the Printer Board to acknowledge it
+         SET_S4REN;                             // re-enable reception to receive the acknowledge
+         TIMESTAMP(ack4_start);                 // the acknowledge wait starts now
+         PROFILE_SENT(tx4_word & 0x1FF);        // does the word just sent finish a command?
+      }
+      else
+         tx4_ready = TRUE;                      // transmit buffer is ready for a new character
+    }
+
+    if(S4RI) {                                  // receive interrupt?
+       CLR_S4RI;                                // clear receive interrupt flag
+       wwBusData = S4BUF;                       // retrieve the lower 8 bits
+       if (S4RB8) wwBusData |= 0x0100;          // ninth bit is in S3RB8
+       TRACE(TRACE_PB,wwBusData);
+       ++rx4_total;
+       if ((tx4_state == TX4_ACK) && !wwBusData) {
+          tx4_state = TX4_IDLE;                 // all zeros is the acknowledge from the Printer Board
+          TIMESTAMP(wait);
+          if (tx4_word & PB_TIMED) {
+             LATENCY_STRUCK(wait);              // a strike timed by latency.c has been acknowledged
+          }
+          wait -= ack4_start;
+          PROFILE_ACKED(wait);                  // add the time taken by the command to its histogram
+          if (ackTiming) {
+             ack4_total += wait;
+             if (wait > ack4_max) ack4_max = wait;
+             ++ack4_count;
+          }
+          TX4_START_NEXT;                       // send the next word in the queue (if any)
+       }
+       else if ((unsigned char)(rx4_head-rx4_tail) != RBUFSIZE4) { // unless the buffer is full...
+          rx4_buf[rx4_head++ & (RBUFSIZE4-1)] = wwBusData;  // save it in the buffer
+          if ((unsigned char)(rx4_head-rx4_tail) > rx4_highWater) rx4_highWater = rx4_head-rx4_tail;
+       }
+       else {
+          ++rx4_overruns;                       // the word is lost
+          errorLED = TRUE;
+       }
+    }
+}
+
+// ---------------------------------------------------------------------------
+//  Initialize UART4 for mode 3. Mode 3 is an asynchronous mode that transmits and receives
+//  a total of 11 bits: 1 start bit, 9 data bits, and 1 stop bit. The ninth bit to be
+//  transmitted is determined by the value in S4TB8 (S4CON.3). When the ninth bit is received,
+//  it is stored in S4RB8 (S4CON.2). The baud rate is determined by the T4 overflow rate.
+//  The formula for calculating the UART4 baud rate is: baud rate = (T4 overflow)/4.
+//  If T4 is operating in 1T mode (T4x12=1), the baud rate of UART4 = SYSclk/(65536-[T4H,T4L])/4.
+//  In this case, the baud rate is: 12,000,000/(65526-65520)/4 = 187500 bps.
+// ---------------------------------------------------------------------------
+void uart4_init(void) {
+    rx4_head = 0;                               // initialize UART4 buffer head/tail pointers.
+    rx4_tail = 0;
+    tx4_head = 0;                               // initialize the command queue head/tail pointers.
+    tx4_tail = 0;
+    tx4_state = TX4_IDLE;
+
+    SET_S4ST4;                                  // set S4ST4 to select Timer 4 as baud rate generator for UART3.
+    CLR_T4_CT;                                  // clear T2_C/T to make Timer 2 operate as timer instead of counter
+    SET_T4x12;                                  // set T2x12=1 to make Timer 2 operate in 1T mode.
+    T4L = 0XF0;                                 // the baud rate of UART3 = 12MHz/(65536-65520)/4 = 187500 bps
+    T4H = 0XFF;
+    SET_T4R;                                    // set T2R to enable Timer 2 to run
+
+    SET_S4SM0;                                  // set S4SM0 for mode 3
+    SET_S4REN;                                  // set S4REN to enable reception
+    SET_S4TI;                                   // set S4TI to enable transmit
+    CLR_S4RI;                                   // clear S4RI
+    SET_ES4;                                    // set ES4 to enable UART4 serial interrupt
+    EA = TRUE;                                  // enable global interrupt
+}
+
+// ---------------------------------------------------------------------------
+// starts sending the command queue if the ISR isn't already sending it. waits
+// no more than BUSPOLLS4 polls for the Wheelwriter bus to go high; if it stays
+// low the queue is left as it is, the stall is counted and the next call tries
+// again. called with the UART4 interrupt disabled.
+// ---------------------------------------------------------------------------
+void tx4_start(void) {
+   unsigned int wwBusData;
+   unsigned char busPolls;
+
+   if ((tx4_state != TX4_IDLE) || (tx4_head == tx4_tail)) return;
+   busPolls = BUSPOLLS4;
+   while (!WWbus4 && --busPolls);               // wait until the Wheelwriter bus goes high
+   if (busPolls) {
+      tx4_stalled = FALSE;
+      TX4_START_NEXT;                           // start sending the oldest word
+   }
+   else if (!tx4_stalled) {                     // count each stall once, not each retry
+      tx4_stalled = TRUE;
+      ++bus4_stalls;
+      errorLED = TRUE;
+   }
+}
+
+// ---------------------------------------------------------------------------
+// puts an unsigned integer into the command queue for the Printer Board.
+// the UART4 ISR sends it as 11 bits (start bit, 9 data bits, stop bit) once
+// the Printer Board has acknowledged all of the words ahead of it in the
+// queue. waits only if the queue is full.
+// ---------------------------------------------------------------------------
+void send_to_printer_board_queued(unsigned int wwCommand) {
+   while ((unsigned char)(tx4_head-tx4_tail) == TBUFSIZE4) // wait while the queue is full...
+      printer_board_busy();                     // ...restarting it if it's waiting for the bus
+   tx4_buf[tx4_head & (TBUFSIZE4-1)] = wwCommand;
+   ++words4;
+   CLR_ES4;                                     // disable UART4 interrupt while updating the queue
+   ++tx4_head;
+   tx4_start();                                 // start sending this word unless the ISR already is
+   SET_ES4;                                     // re-enable UART4 interrupt
+}
+
+// ---------------------------------------------------------------------------
+// when 'on' is TRUE, clears the word count and the acknowledge wait
+// statistics and starts timing each word's acknowledge. when FALSE, stops.
+// ---------------------------------------------------------------------------
+void ack_timing(unsigned char on) {
+   CLR_ES4;
+   if (on) {
+      words4 = 0;
+      ack4_count = 0;
+      ack4_total = 0;
+      ack4_max = 0;
+   }
+   ackTiming = on;
+   SET_ES4;
+}
+
+// ---------------------------------------------------------------------------
+// returns 1 while there are words in the command queue or the Printer Board
+// has not yet acknowledged the last word sent. a queue left waiting for the
+// bus by tx4_start() is started again from here.
+// ---------------------------------------------------------------------------
+char printer_board_busy(void) {
+   if ((tx4_state == TX4_IDLE) && (tx4_head != tx4_tail)) {
+      CLR_ES4;
+      tx4_start();
+      SET_ES4;
+   }
+   return ((tx4_head != tx4_tail) || (tx4_state != TX4_IDLE));
+}
+
+// ---------------------------------------------------------------------------
+// puts an unsigned integer into the command queue for the Printer Board and
+// waits until the Printer Board has acknowledged it.
+// ---------------------------------------------------------------------------
+void send_to_printer_board_wait(unsigned int wwCommand) {
+   send_to_printer_board_queued(wwCommand);
+   while (printer_board_busy());                // wait for the queue to empty and the acknowledge
+}
+
+// ---------------------------------------------------------------------------
+// sends an unsigned integer as 11 bits (start bit, 9 data bits, stop bit)
+// to the Printer Board. does not wait for acknowledge from printer board.
+// bypasses the command queue; only used while relaying commands from the
+// Function Board (during initialization and in passthrough mode) when
+// nothing is queued.
+// ---------------------------------------------------------------------------
+void send_to_printer_board(unsigned int wwCommand) {
+   while (!tx4_ready);                          // wait until transmit buffer is empty
+   tx4_ready = 0;                               // clear flag
+   while(!WWbus4);                              // wait until the Wheelwriter bus goes high
+   CLR_S4REN;                                   // clear S4REN to disable reception
+   if (wwCommand & 0x100) SET_S4TB8; else CLR_S4TB8; // 9th bit
+   S4BUF = wwCommand & 0xFF;                    // lower 8 bits
+   TRACE(TRACE_TOPB,wwCommand);
+   while(!tx4_ready);                           // wait until finished transmitting
+   while(!WWbus4);                              // wait until the Wheelwriter bus goes high
+   SET_S4REN;                                   // set S4REN to re-enable reception
+}
+
+// ---------------------------------------------------------------------------
+// returns 1 if there is an unsigned integer from the Printer Board waiting in the UART4 receive buffer.
+// ---------------------------------------------------------------------------
+char printer_board_reply_avail(void) {
+   return (rx4_head != rx4_tail);               // not equal means there's something in the buffer
+}
+
+//----------------------------------------------------------------------------
+// returns the next unsigned integer from the Printer Board in the UART4 receive buffer.
+// waits for an integer to become available if necessary.
+//----------------------------------------------------------------------------
+unsigned int get_printer_board_reply(void) {
+    unsigned int buf;
+
+    while (rx4_head == rx4_tail);               // wait until a word is available
+    buf = rx4_buf[rx4_tail++ & (RBUFSIZE4-1)];  // retrieve the word from the buffer
+    return(buf);
+}
+
+// ---------------------------------------------------------------------------
+// prints the UART4 receive buffer statistics on one line: the buffer size,
+// the most words ever waiting, the words lost and received
+// ---------------------------------------------------------------------------
+void uart4_stats(void) {
+    unsigned int overruns;
+    unsigned char highWater;
+    unsigned long total;
+
+    CLR_ES4;
+    overruns = rx4_overruns;
+    highWater = rx4_highWater;
+    total = rx4_total;
+    SET_ES4;
+    printf("%-12s %5u %10u %9u %11lu\n","UART4 PB",RBUFSIZE4,(int)highWater,overruns,total);
+}
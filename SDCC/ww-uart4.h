@@ -1,13 +1,28 @@
-// for the Small Device C Compiler (SDCC)
-
-#ifndef __UART4_H__
-#define __UART4_H__
-
-void uart4_isr(void) __interrupt(18) __using(3);
-void uart4_init(void);
-void send_to_printer_board(unsigned int wwCommand);
-void send_to_printer_board_wait(unsigned int wwCommand);
-char printer_board_reply_avail(void);
-unsigned int get_printer_board_reply(void);
-
-#endif
+// for the Small Device C Compiler (SDCC)
+
+#ifndef __UART4_H__
+#define __UART4_H__
+
+#define PB_TIMED 0x8000                 // set in a queued word, not sent: the word ends a strike timed by latency.c
+
+void uart4_isr(void) __interrupt(18) __using(3);
+void uart4_init(void);
+void send_to_printer_board(unsigned int wwCommand);
+void send_to_printer_board_queued(unsigned int wwCommand);
+void send_to_printer_board_wait(unsigned int wwCommand);
+char printer_board_busy(void);
+char printer_board_reply_avail(void);
+unsigned int get_printer_board_reply(void);
+void ack_timing(unsigned char on);
+void uart4_stats(void);
+
+extern volatile unsigned long __xdata words4;
+extern volatile unsigned long __xdata ack4_count;
+extern volatile unsigned long __xdata ack4_total;
+extern volatile unsigned long __xdata ack4_max;
+extern volatile unsigned int __xdata rx4_overruns;
+extern volatile unsigned char __xdata rx4_highWater;
+extern volatile unsigned long __xdata rx4_total;
+extern volatile unsigned int __xdata bus4_stalls;
+
+#endif
@@ -0,0 +1,101 @@
+//------------------------------------------------------------------------------------------
+// hal_host - recording backend for the host build of wheelwriter.c and diablo.c
+//
+// Provides the functions and variables that wheelwriter.c and diablo.c use from the rest
+// of the firmware. The Printer Board is the model in pbmodel.c: each word is acknowledged
+// at once and its mechanical time is added to the modeled time, as if the UART4 ISR had
+// sent the queue back to back.
+//------------------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include "hal.h"
+#include "uart2.h"
+#include "ww-uart4.h"
+#include "eeprom.h"
+#include "timebase.h"
+#include "hal_host.h"
+
+FILE *hal_record = NULL;
+FILE *hal_echo = NULL;
+unsigned long hal_host_bytes = 0;
+
+// defined in main.c on the target
+unsigned char localMode = 1;
+unsigned char passthrough = 0;
+unsigned long hostBaudRate = 9600;
+unsigned char idleFlush = 10;
+
+static unsigned char settings[16] = {                  // an erased EEPROM reads 0xFF
+    0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF
+};
+
+//------------------------------------------------------------------------------------------
+// starts a new page on the Printer Board model and clears the counts
+//------------------------------------------------------------------------------------------
+void hal_init(const pb_timing_t *timing,int uSpacesPerChar,int uLinesPerLine,unsigned int printWheel) {
+    pb_init(timing,uSpacesPerChar,uLinesPerLine,printWheel);
+    hal_host_bytes = 0;
+}
+
+//------------------------------------------------------------------------------------------
+// ww-uart4.c: the words sent to the Printer Board
+//------------------------------------------------------------------------------------------
+void send_to_printer_board_queued(unsigned int wwCommand) {
+    if (hal_record) fprintf(hal_record,"%03X\n",wwCommand & 0x1FF);
+    pb_word(wwCommand & 0x1FF,NULL);
+}
+
+void send_to_printer_board_wait(unsigned int wwCommand) {
+    send_to_printer_board_queued(wwCommand);
+}
+
+void send_to_printer_board(unsigned int wwCommand) {
+    send_to_printer_board_queued(wwCommand);
+}
+
+char printer_board_busy(void) {
+    return 0;
+}
+
+//------------------------------------------------------------------------------------------
+// timebase.c: the modeled time. the Printer Board has already carried out everything
+// queued, so printer_board_busy() never waits
+//------------------------------------------------------------------------------------------
+unsigned long timestamp(void) {
+    return (unsigned long)pb_stats()->elapsed;
+}
+
+//------------------------------------------------------------------------------------------
+// uart1.c: characters echoed to the debug console
+//------------------------------------------------------------------------------------------
+int hal_putchar(int c) {
+    if (hal_echo) fputc(c,hal_echo);
+    return c;
+}
+
+//------------------------------------------------------------------------------------------
+// uart2.c: replies to the host
+//------------------------------------------------------------------------------------------
+char putchar2(char c) {
+    ++hal_host_bytes;
+    return c;
+}
+
+void uart2_baudrate(unsigned long baudrate) {
+    hostBaudRate = baudrate;
+}
+
+unsigned char uart2_watermarks(unsigned char pauseLevel,unsigned char resumeLevel) {
+    return pauseLevel && (pauseLevel < resumeLevel);
+}
+
+//------------------------------------------------------------------------------------------
+// eeprom.c: settings are kept in memory only
+//------------------------------------------------------------------------------------------
+unsigned char get_setting(unsigned char offset) {
+    return settings[offset & 0x0F];
+}
+
+void save_setting(unsigned char offset,unsigned char value) {
+    settings[offset & 0x0F] = value;
+}
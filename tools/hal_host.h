@@ -0,0 +1,22 @@
+//------------------------------------------------------------------------------------------
+// hal_host - recording backend for the host build of wheelwriter.c and diablo.c
+//
+// Stands in for uart1.c, uart2.c, ww-uart4.c, eeprom.c, timebase.c and main.c when the print
+// path is compiled with gcc (see ../SDCC/hal.h). Every word queued for the Printer Board is
+// counted, optionally written to a file as a hex word and fed to the Printer Board model in
+// pbmodel.c, which keeps the modeled time and travel.
+//------------------------------------------------------------------------------------------
+
+#ifndef __HAL_HOST_H__
+#define __HAL_HOST_H__
+
+#include <stdio.h>
+#include "pbmodel.h"
+
+extern FILE *hal_record;                // words sent to the Printer Board, one hex word per line, NULL for none
+extern FILE *hal_echo;                  // characters echoed to UART1, NULL to discard
+extern unsigned long hal_host_bytes;    // bytes sent to the host on UART2 (ACKs and replies)
+
+void hal_init(const pb_timing_t *timing,int uSpacesPerChar,int uLinesPerLine,unsigned int printWheel);
+
+#endif
@@ -0,0 +1,232 @@
+//------------------------------------------------------------------------------------------
+// pbmodel - model of the Wheelwriter Printer Board
+//
+// Each word sent to the Printer Board is acknowledged with an all zero word, except the
+// 0x001 of the 0x121,0x001 reset command which is answered with the printwheel pitch.
+// The acknowledge of the last word of a command is delayed by the mechanical time the
+// command takes:
+//   0x121,0x003,code,advance   printwheel turns the shorter way to 'code', strikes, then
+//                              the carrier advances 'advance' micro spaces
+//   0x121,0x004,code,n         as 0x003 but strikes the correction tape, no advance
+//   0x121,0x005,data           paper moves bits 0-4 micro lines, up if bit 7 is set
+//   0x121,0x006,high,low       carrier moves an 11 bit number of micro spaces, right if
+//                              bit 7 of 'high' is set
+//   0x121,0x007                printwheel spins one full turn
+// Any other word is acknowledged after the word time only.
+//------------------------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <string.h>
+#include "pbmodel.h"
+
+#define SPOKES   96
+#define MAXROWS  512
+#define MAXCOLS  256
+
+const pb_timing_t pb_default_timing = {
+    58.7,                               // 11 bits at 187500bps
+    1000.0,                             // per spoke
+    20000.0,                            // settle and strike
+    5000.0,                             // carrier start and stop
+    250.0,                              // per micro space
+    10000.0,                            // platen start and stop
+    1200.0                              // per micro line
+};
+
+// the character at each spoke of the printwheel: the inverse of ASCII2printwheel[] in
+// wheelwriter.c, with printwheel2ASCII[] for the spokes ASCII2printwheel[] doesn't use.
+// the symbols with no ASCII equivalent are shown as '?'
+static const char wheel[SPOKES+1] =
+    "anrmcsdhlfk,V-GU"
+    "FBZHP)RLSNCTDEIA"
+    "JO(M>Y</W9K3X120"
+    "54687*$#%^+`@Q&]"
+    "[\\|~<>}{!?\"'=:_;"
+    "xqvzwj.ybgupitoe";
+
+static pb_timing_t timing;
+static pb_stats_t stats;
+static int spacesPerChar,linesPerLine;
+static unsigned int pitch;
+static int state;                       // position in the current command
+static unsigned int cmd[4];             // words of the current command
+static int wheelPos;                    // printwheel code at the print point
+static long x,y;                        // carrier position in micro spaces, paper position in micro lines
+static char page[MAXROWS][MAXCOLS];     // what has been struck at each character cell
+static char underline[MAXROWS][MAXCOLS];// cells with an underscore struck
+static int rows;                        // rows used
+
+//------------------------------------------------------------------------------------------
+// starts a new page with the carrier at the left margin and the printwheel at 'a'.
+// 'printWheel' is the pitch reported in reply to the reset command (0x020 for 12P).
+//------------------------------------------------------------------------------------------
+void pb_init(const pb_timing_t *t,int uSpacesPerChar,int uLinesPerLine,unsigned int printWheel) {
+    timing = t ? *t : pb_default_timing;
+    spacesPerChar = uSpacesPerChar;
+    linesPerLine = uLinesPerLine;
+    pitch = printWheel;
+    memset(&stats,0,sizeof(stats));
+    memset(page,' ',sizeof(page));
+    memset(underline,0,sizeof(underline));
+    state = 0;
+    wheelPos = 1;
+    x = y = 0;
+    rows = 0;
+}
+
+//------------------------------------------------------------------------------------------
+// character cell of the current print point, NULL if it's off the virtual page
+//------------------------------------------------------------------------------------------
+static char *cell(char (*grid)[MAXCOLS]) {
+    long row,col;
+
+    row = (y+linesPerLine/2)/linesPerLine;
+    col = (x+spacesPerChar/2)/spacesPerChar;
+    if ((y < 0) || (row >= MAXROWS) || (col < 0) || (col >= MAXCOLS)) return NULL;
+    if (row >= rows) rows = row+1;
+    return &grid[row][col];
+}
+
+//------------------------------------------------------------------------------------------
+// turns the printwheel to 'code', returns the time taken
+//------------------------------------------------------------------------------------------
+static double turn_wheel(int code) {
+    int d;
+
+    if ((code < 1) || (code > SPOKES)) return 0;
+    d = abs(code-wheelPos);
+    if (d > SPOKES/2) d = SPOKES-d;
+    wheelPos = code;
+    stats.wheelTravel += d;
+    return d*timing.spoke;
+}
+
+//------------------------------------------------------------------------------------------
+// moves the carrier 'n' micro spaces (negative is to the left), returns the time taken
+//------------------------------------------------------------------------------------------
+static double move_carrier(long n) {
+    if (!n) return 0;
+    x += n;
+    if (x < 0) x = 0;                   // the carrier stops at the left margin
+    stats.carrierTravel += labs(n);
+    return timing.carrierStart+labs(n)*timing.carrierPerMicroSpace;
+}
+
+//------------------------------------------------------------------------------------------
+// moves the paper 'n' micro lines (positive is up), returns the time taken
+//------------------------------------------------------------------------------------------
+static double move_paper(long n) {
+    if (!n) return 0;
+    y += n;
+    stats.paperTravel += labs(n);
+    return timing.paperStart+labs(n)*timing.paperPerMicroLine;
+}
+
+//------------------------------------------------------------------------------------------
+// carries out a complete command, returns the mechanical time taken
+//------------------------------------------------------------------------------------------
+static double execute(void) {
+    double t = 0;
+    char *c,*u;
+
+    ++stats.commands;
+    switch(cmd[1]) {
+        case 0x003:                                         // strike
+            if (cmd[2] && (cmd[2] <= SPOKES)) {
+                t = turn_wheel(cmd[2])+timing.strike;
+                ++stats.glyphs;
+                if (wheel[cmd[2]-1] == '_') {
+                    if ((u = cell(underline))) *u = 1;
+                }
+                else if ((c = cell(page))) *c = wheel[cmd[2]-1];
+            }
+            t += move_carrier(cmd[3]);
+            break;
+        case 0x004:                                         // strike on the correction tape
+            if (cmd[2] && (cmd[2] <= SPOKES)) {
+                t = turn_wheel(cmd[2])+timing.strike;
+                ++stats.erased;
+                if (wheel[cmd[2]-1] == '_') {
+                    if ((u = cell(underline))) *u = 0;
+                }
+                else if ((c = cell(page))) *c = ' ';
+            }
+            break;
+        case 0x005:                                         // vertical
+            t = move_paper((cmd[2] & 0x80) ? (long)(cmd[2] & 0x1F) : -(long)(cmd[2] & 0x1F));
+            break;
+        case 0x006:                                         // horizontal
+            t = move_carrier((cmd[2] & 0x80) ? (long)(((cmd[2] & 0x07)<<8)|cmd[3]) : -(long)(((cmd[2] & 0x07)<<8)|cmd[3]));
+            break;
+        case 0x007:                                         // spin
+            stats.wheelTravel += SPOKES;
+            t = SPOKES*timing.spoke;
+            break;
+    }
+    stats.elapsed += t;
+    return t;
+}
+
+//------------------------------------------------------------------------------------------
+// processes one 9 bit word sent to the Printer Board. returns the reply (0 is the
+// acknowledge) and sets 'usec' to the time from the start of the word to the reply.
+//------------------------------------------------------------------------------------------
+unsigned int pb_word(unsigned int word,double *usec) {
+    unsigned int reply = 0;
+    double t = timing.word;
+    int length;
+
+    ++stats.words;
+    stats.elapsed += timing.word;
+    if (state == 0) {                                       // commands start with 0x121
+        if (word == 0x121) cmd[state++] = word;
+    }
+    else {
+        cmd[state++] = word;
+        switch(cmd[1]) {
+            case 0x003:
+            case 0x004:
+            case 0x006: length = 4; break;
+            case 0x005: length = 3; break;
+            case 0x001:                                     // reset, reply with the printwheel pitch
+                reply = pitch;
+                length = 2;
+                break;
+            default:    length = 2;
+        }
+        if (state == length) {
+            t += execute();
+            state = 0;
+        }
+    }
+    if (usec) *usec = t;
+    return reply;
+}
+
+//------------------------------------------------------------------------------------------
+// returns the statistics so far
+//------------------------------------------------------------------------------------------
+const pb_stats_t *pb_stats(void) {
+    return &stats;
+}
+
+//------------------------------------------------------------------------------------------
+// writes the virtual page as text. underlined characters are followed by backspace and
+// underscore, as nroff does, so that 'less' or 'ul' show them underlined.
+//------------------------------------------------------------------------------------------
+void pb_render(FILE *f) {
+    int r,c,last;
+
+    for(r=0; r<rows; r++) {
+        for(last=MAXCOLS-1; (last >= 0) && (page[r][last] == ' ') && !underline[r][last]; last--);
+        for(c=0; c<=last; c++) {
+            if (underline[r][c] && (page[r][c] != ' '))
+                fprintf(f,"%c\b_",page[r][c]);
+            else if (underline[r][c])
+                fputc('_',f);
+            else
+                fputc(page[r][c],f);
+        }
+        fputc('\n',f);
+    }
+}
@@ -0,0 +1,42 @@
+//------------------------------------------------------------------------------------------
+// pbmodel - model of the Wheelwriter Printer Board: acknowledges the 9 bit words of the
+// Printer Board protocol, estimates the mechanical time taken by each command and keeps
+// a virtual page of what has been printed.
+//------------------------------------------------------------------------------------------
+
+#ifndef __PBMODEL_H__
+#define __PBMODEL_H__
+
+#include <stdio.h>
+
+// the timing model, all times in microseconds
+typedef struct {
+    double word;                        // one 11 bit word on the bus
+    double spoke;                       // turning the printwheel one spoke
+    double strike;                      // settling the printwheel and striking
+    double carrierStart;                // starting and stopping the carrier
+    double carrierPerMicroSpace;        // moving the carrier one micro space
+    double paperStart;                  // starting and stopping the platen
+    double paperPerMicroLine;           // moving the paper one micro line
+} pb_timing_t;
+
+// what the Printer Board has done so far
+typedef struct {
+    unsigned long words;                // words received
+    unsigned long commands;             // commands received
+    unsigned long glyphs;               // characters struck (not counting spaces)
+    unsigned long erased;               // characters struck on the correction tape
+    unsigned long carrierTravel;        // micro spaces the carrier has moved
+    unsigned long wheelTravel;          // spokes the printwheel has turned
+    unsigned long paperTravel;          // micro lines the paper has moved
+    double elapsed;                     // modeled time in microseconds
+} pb_stats_t;
+
+extern const pb_timing_t pb_default_timing;
+
+void pb_init(const pb_timing_t *timing,int uSpacesPerChar,int uLinesPerLine,unsigned int printWheel);
+unsigned int pb_word(unsigned int word,double *usec);
+const pb_stats_t *pb_stats(void);
+void pb_render(FILE *f);
+
+#endif
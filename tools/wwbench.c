@@ -0,0 +1,247 @@
+//------------------------------------------------------------------------------------------
+// wwbench - pushes text through the firmware's print path on Linux
+//
+// For Linux (gcc). Links print_char_on_WW() from diablo.c and the ww_* functions from
+// wheelwriter.c, compiled from ../SDCC unchanged through hal.h, against the recording
+// backend in hal_host.c. Every byte of the input is handed to print_char_on_WW() as if it
+// had arrived on UART2, the line buffer is flushed at the end, and the words sent to the
+// Printer Board are counted and timed with the model in pbmodel.c. The strike ordering cost
+// model is the one the calibration command (<ESC><^Z><k>) works out for the model's timing.
+//
+// usage: wwbench [options] [file...]
+//   -b          line buffering and bidirectional printing (<ESC></>)
+//   -o          printwheel-aware strike ordering (<ESC><o>1)
+//   -r file     write the words sent to the Printer Board to 'file', one hex word per line
+//   -p          show the page as it would have been printed
+//   -n n        push the input through n times (default 1)
+//   -t          run each file on its own from power-on settings and print one line per file:
+//               chars/sec, bus words per glyph, modeled time, carrier and printwheel travel
+//   -c          run each file on its own with strike ordering off and on, exit with 1 if
+//               ordering makes any of them slower
+//   -i          the host stops sending after each linefeed long enough for the main loop's
+//               idle flush (ww_idle()) to run
+//------------------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/wait.h>
+#include "hal.h"
+#include "wheelwriter.h"
+#include "diablo.h"
+#include "eeprom.h"
+#include "hal_host.h"
+
+#define WORDS 4                         // words in a strike or carrier command
+
+extern unsigned char strikeOrdering;    // defined in wheelwriter.c
+
+static int idle = 0;                    // -i
+
+static void usage(void) {
+    fprintf(stderr,"usage: wwbench [-b] [-o] [-r file] [-p] [-n n] [-t] [-c] [-i] [file...]\n");
+    exit(1);
+}
+
+//------------------------------------------------------------------------------------------
+// reads the whole of 'f', returns the number of bytes read into '*buf'
+//------------------------------------------------------------------------------------------
+static size_t slurp(FILE *f,unsigned char **buf,size_t have) {
+    size_t size = have+65536,n;
+
+    while ((*buf = realloc(*buf,size)) && ((n = fread(*buf+have,1,size-have,f)) > 0)) {
+        have += n;
+        if (have == size) size *= 2;
+    }
+    if (!*buf) {
+        fprintf(stderr,"wwbench: out of memory\n");
+        exit(1);
+    }
+    return have;
+}
+
+//------------------------------------------------------------------------------------------
+// starts a new page and puts the firmware back in its power-on print settings, with the
+// strike ordering cost model calibrate_run() saves for the model's default timing (see
+// wwcal.c): no printwheel settle cost, and the time per spoke, the carrier's start and stop
+// and the bus words of a move command in micro spaces
+//------------------------------------------------------------------------------------------
+static void reset(int buffering,int ordering) {
+    const pb_timing_t *t = &pb_default_timing;
+
+    hal_init(NULL,10,16,0x20);
+    save_setting(EE_WHEELSETTLE,0);
+    save_setting(EE_WHEELPERSPOKE,(unsigned char)(t->spoke/t->carrierPerMicroSpace+0.5));
+    save_setting(EE_CARRIERSTART,(unsigned char)(t->carrierStart/t->carrierPerMicroSpace+0.5));
+    save_setting(EE_CARRIERMOVE,(unsigned char)(WORDS*t->word/t->carrierPerMicroSpace+0.5));
+    ww_init();
+    ww_line_buffering(buffering);
+    strikeOrdering = ordering;
+}
+
+//------------------------------------------------------------------------------------------
+// hands 'length' bytes of 'text' to print_char_on_WW() 'passes' times and flushes the line
+// buffer. returns the processor time taken.
+//------------------------------------------------------------------------------------------
+static double run(const unsigned char *text,size_t length,int passes) {
+    clock_t start;
+    size_t i;
+    int n;
+
+    start = clock();
+    for(n=0; n<passes; n++)
+        for(i=0; i<length; i++) {
+            print_char_on_WW(text[i]);
+            if (idle && (text[i] == '\n')) ww_idle();
+        }
+    ww_flush();
+    return (double)(clock()-start)/CLOCKS_PER_SEC;
+}
+
+//------------------------------------------------------------------------------------------
+// runs 'text' as run() does in a child process, so that the firmware starts from its power-on
+// state and not from where the last file left the carrier and printwheel. returns what the
+// model counted.
+//------------------------------------------------------------------------------------------
+static pb_stats_t run_fresh(const unsigned char *text,size_t length,int passes,int buffering,int ordering) {
+    pb_stats_t s;
+    pid_t pid;
+    int fd[2];
+
+    if (pipe(fd) || ((pid = fork()) < 0)) {
+        perror("wwbench");
+        exit(1);
+    }
+    if (!pid) {
+        close(fd[0]);
+        reset(buffering,ordering);
+        run(text,length,passes);
+        s = *pb_stats();
+        if (hal_record) fflush(hal_record);
+        _exit(write(fd[1],&s,sizeof(s)) == sizeof(s) ? 0 : 1);
+    }
+    close(fd[1]);
+    if (read(fd[0],&s,sizeof(s)) != sizeof(s)) {
+        fprintf(stderr,"wwbench: run failed\n");
+        exit(1);
+    }
+    close(fd[0]);
+    waitpid(pid,NULL,0);
+    return s;
+}
+
+//------------------------------------------------------------------------------------------
+// one line of the table printed by -t
+//------------------------------------------------------------------------------------------
+static void row(const char *name,size_t bytes,const pb_stats_t *s) {
+    const char *p = strrchr(name,'/');
+
+    printf("%-14s %8lu %8lu %9.2f %11.2f %10.2f %10lu %10lu\n",p ? p+1 : name,(unsigned long)bytes,s->glyphs,
+           (s->elapsed > 0) ? s->glyphs/(s->elapsed/1000000.0) : 0.0,s->glyphs ? (double)s->words/s->glyphs : 0.0,
+           s->elapsed/1000000.0,s->carrierTravel,s->wheelTravel);
+}
+
+int main(int argc,char *argv[]) {
+    unsigned char *text = NULL;
+    size_t length = 0;
+    int buffering = 0,ordering = 0,page = 0,table = 0,compare = 0,slower = 0,passes = 1,opt;
+    const pb_stats_t *s;
+    pb_stats_t unordered,ordered;
+    double cpu;
+    FILE *f;
+
+    while ((opt = getopt(argc,argv,"bor:pn:tci")) != -1) {
+        switch(opt) {
+            case 'b': buffering = 1; break;
+            case 'o': ordering = 1; break;
+            case 'r':
+                if (!(hal_record = fopen(optarg,"w"))) {
+                    perror(optarg);
+                    return 1;
+                }
+                break;
+            case 'p': page = 1; break;
+            case 'n': passes = atoi(optarg); break;
+            case 't': table = 1; break;
+            case 'c': compare = 1; break;
+            case 'i': idle = 1; break;
+            default: usage();
+        }
+    }
+    if (passes < 1) usage();
+
+    if (table) {                                            // each file on its own, one line each
+        printf("%-14s %8s %8s %9s %11s %10s %10s %10s\n","corpus","bytes","chars","chars/sec","words/glyph","time s","carrier","wheel");
+        for(; optind<argc; optind++) {
+            if (!(f = fopen(argv[optind],"rb"))) {
+                perror(argv[optind]);
+                return 1;
+            }
+            length = slurp(f,&text,0);
+            fclose(f);
+            ordered = run_fresh(text,length,passes,buffering,ordering);
+            row(argv[optind],length*passes,&ordered);
+        }
+        free(text);
+        return 0;
+    }
+
+    if (compare) {                                          // each file on its own, ordered and not
+        for(; optind<argc; optind++) {
+            if (!(f = fopen(argv[optind],"rb"))) {
+                perror(argv[optind]);
+                return 1;
+            }
+            length = slurp(f,&text,0);
+            fclose(f);
+            unordered = run_fresh(text,length,passes,buffering,0);
+            ordered = run_fresh(text,length,passes,buffering,1);
+            printf("%-14s %9.2f s unordered %9.2f s ordered: %s\n",strrchr(argv[optind],'/') ? strrchr(argv[optind],'/')+1 : argv[optind],
+                   unordered.elapsed/1000000.0,ordered.elapsed/1000000.0,(ordered.elapsed > unordered.elapsed) ? "SLOWER" : "ok");
+            if (ordered.elapsed > unordered.elapsed) slower = 1;
+        }
+        free(text);
+        return slower;
+    }
+
+    if (optind == argc)
+        length = slurp(stdin,&text,0);
+    for(; optind<argc; optind++) {
+        if (!(f = fopen(argv[optind],"rb"))) {
+            perror(argv[optind]);
+            return 1;
+        }
+        length = slurp(f,&text,length);
+        fclose(f);
+    }
+
+    reset(buffering,ordering);
+    cpu = run(text,length,passes);
+
+    s = pb_stats();
+    printf("input:            %lu bytes\n",(unsigned long)length*passes);
+    printf("words:            %lu\n",s->words);
+    printf("commands:         %lu\n",s->commands);
+    printf("characters:       %lu\n",s->glyphs);
+    if (length)
+        printf("words/byte:       %.2f\n",(double)s->words/(length*passes));
+    if (s->glyphs)
+        printf("words/char:       %.2f\n",(double)s->words/s->glyphs);
+    printf("modeled time:     %.3f s\n",s->elapsed/1000000.0);
+    if (s->elapsed > 0)
+        printf("chars/sec:        %.2f\n",s->glyphs/(s->elapsed/1000000.0));
+    printf("carrier travel:   %lu micro spaces\n",s->carrierTravel);
+    printf("printwheel travel:%lu spokes\n",s->wheelTravel);
+    printf("paper travel:     %lu micro lines\n",s->paperTravel);
+    if (cpu > 0)
+        printf("host parser:      %.1f MB/s\n",length*passes/cpu/1000000.0);
+    if (page) {
+        printf("\n");
+        pb_render(stdout);
+    }
+    if (hal_record) fclose(hal_record);
+    free(text);
+    return 0;
+}
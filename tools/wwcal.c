@@ -0,0 +1,155 @@
+//------------------------------------------------------------------------------------------
+// wwcal - checks the calibration command against the Printer Board model
+//
+// For Linux (gcc). Runs calibrate_run() from calibrate.c, compiled from ../SDCC unchanged
+// (its arithmetic is in sized types, see hal.h), against the model in pbmodel.c for several
+// timings. The fixed time and time per spoke, micro space and micro line it prints on UART1
+// must match the model's, and the strike ordering cost model it saves in the EEPROM, the
+// printwheel costs and the carrier's start and move costs, must match the one worked out from
+// the model's timing.
+//
+// usage: wwcal [-v]
+//   -v          show the output of each calibration
+//
+// exits with 0 if every calibration matched
+//------------------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "hal.h"
+#include "wheelwriter.h"
+#include "eeprom.h"
+#include "calibrate.h"
+#include "hal_host.h"
+
+#define WORDS   4                       // words in a strike or carrier command
+#define TOLERANCE 0.01                  // largest error allowed, as a fraction of the model's time
+
+extern unsigned char uSpacesPerChar;    // defined in wheelwriter.c
+
+// the timings checked: the model's defaults, then slower and faster mechanisms
+static const pb_timing_t timings[] = {
+    {58.7,1000.0,20000.0,5000.0,250.0,10000.0,1200.0},
+    {58.7,1500.0,30000.0,8000.0,600.0,15000.0,2000.0},
+    {58.7, 600.0,12000.0,3000.0,120.0, 6000.0, 800.0},
+    {58.7,2000.0,25000.0,6000.0,1000.0,12000.0,1500.0}
+};
+
+static int failures = 0;
+
+//------------------------------------------------------------------------------------------
+// compares a value printed by calibrate_run() with the model's
+//------------------------------------------------------------------------------------------
+static void check(const char *what,long got,double want) {
+    double error = got-want;
+
+    if (error < 0) error = -error;
+    if (error > want*TOLERANCE+1.0) {
+        printf("  %-26s %8ld, expected %8.0f\n",what,got,want);
+        ++failures;
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// runs the calibration with timing 't', checks what it printed and saved
+//------------------------------------------------------------------------------------------
+static void calibrate(const pb_timing_t *t,int verbose) {
+    char line[256];
+    long fixed,slope,still;
+    int found = 0,settle,perSpoke,carrierStart,carrierMove;
+    double carrier;
+    FILE *out;
+    int console;
+
+    if (!(out = tmpfile())) {
+        perror("wwcal");
+        exit(1);
+    }
+    save_setting(EE_WHEELSETTLE,0xFF);
+    save_setting(EE_WHEELPERSPOKE,0xFF);
+    save_setting(EE_CARRIERSTART,0xFF);
+    save_setting(EE_CARRIERMOVE,0xFF);
+    hal_init(t,10,16,0x20);
+    ww_init();
+    fflush(stdout);                                         // calibrate_run() prints with printf()
+    console = dup(STDOUT_FILENO);
+    dup2(fileno(out),STDOUT_FILENO);
+    calibrate_run();
+    fflush(stdout);
+    dup2(console,STDOUT_FILENO);
+    close(console);
+
+    printf("spoke %4.0f us, carrier %4.0f us + %4.0f us/micro space: ",t->spoke,t->carrierStart,t->carrierPerMicroSpace);
+    failures = 0;
+    rewind(out);
+    carrier = t->carrierStart+uSpacesPerChar*t->carrierPerMicroSpace;  // each strike advances the carrier
+    while (fgets(line,sizeof(line),out)) {
+        if (verbose) printf("\n  %s",line);
+        if (sscanf(line,"printwheel: %ld us + %ld us/spoke, %ld us without turning",&fixed,&slope,&still) == 3) {
+            check("printwheel fixed time",fixed,WORDS*t->word+t->strike+carrier);
+            check("printwheel time per spoke",slope,t->spoke);
+            check("strike without turning",still,WORDS*t->word+t->strike+carrier);
+            found |= 0x01;
+        }
+        else if (sscanf(line,"carrier: %ld us + %ld us/micro space",&fixed,&slope) == 2) {
+            check("carrier fixed time",fixed,WORDS*t->word+t->carrierStart);
+            check("carrier time per micro space",slope,t->carrierPerMicroSpace);
+            found |= 0x02;
+        }
+        else if (sscanf(line,"paper: %ld us + %ld us/micro line",&fixed,&slope) == 2) {
+            check("paper fixed time",fixed,3*t->word+t->paperStart);
+            check("paper time per micro line",slope,t->paperPerMicroLine);
+            found |= 0x04;
+        }
+    }
+    fclose(out);
+    if (found != 0x07) {
+        printf("%s  calibration failed or incomplete\n",verbose ? "\n" : "");
+        ++failures;
+    }
+
+    // the model turns the printwheel in a time proportional to the distance, so all of
+    // the strike's fixed time is there without turning as well: no settle cost
+    settle = get_setting(EE_WHEELSETTLE);
+    perSpoke = get_setting(EE_WHEELPERSPOKE);
+    slope = (long)(t->spoke/t->carrierPerMicroSpace+0.5);
+    if (slope < 1) slope = 1;
+    if (slope > 255/48) slope = 255/48;
+    if ((settle > 1) || (perSpoke != slope)) {
+        printf("  saved cost model %d + %d per spoke, expected 0 + %ld per spoke\n",settle,perSpoke,slope);
+        ++failures;
+    }
+
+    // the carrier's fixed time in micro spaces, split into starting and stopping and the
+    // bus words of the move command
+    carrierStart = get_setting(EE_CARRIERSTART);
+    carrierMove = get_setting(EE_CARRIERMOVE);
+    fixed = (long)(t->carrierStart/t->carrierPerMicroSpace+0.5);
+    slope = (long)(WORDS*t->word/t->carrierPerMicroSpace+0.5);
+    if ((carrierStart < fixed-1) || (carrierStart > fixed+1) || (carrierMove < slope-1) || (carrierMove > slope+1)) {
+        printf("  saved carrier start %d, move %d, expected %ld, %ld\n",carrierStart,carrierMove,fixed,slope);
+        ++failures;
+    }
+    printf("%s\n",failures ? "FAILED" : "ok");
+}
+
+int main(int argc,char *argv[]) {
+    int verbose = 0,failed = 0,opt;
+    size_t i;
+
+    while ((opt = getopt(argc,argv,"v")) != -1) {
+        switch(opt) {
+            case 'v': verbose = 1; break;
+            default:
+                fprintf(stderr,"usage: wwcal [-v]\n");
+                return 1;
+        }
+    }
+    for(i=0; i<sizeof(timings)/sizeof(timings[0]); i++) {
+        calibrate(&timings[i],verbose);
+        if (failures) ++failed;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,121 @@
+//------------------------------------------------------------------------------------------
+// wwprinter - Wheelwriter Printer Board emulator
+//
+// For Linux (gcc). Plays the Printer Board's side of the 9 bit protocol sent by ww-uart4.c
+// using the timing model in pbmodel.c, then reports the modeled print time, characters per
+// second, bus words per character and carrier, printwheel and paper travel, and shows the
+// page as it would have been printed.
+//
+// The words sent to the Printer Board are read from a file or standard input, either as hex
+// words separated by spaces or newlines, or as a bus trace dumped by <ESC><^Z><d> (only the
+// words sent to the Printer Board, source 2, are used).
+//
+// usage: wwprinter [options] [file]
+//   -a          write each reply (000 is the acknowledge) to standard output as a hex word,
+//               after the modeled delay, so the emulator can be driven through a pipe. the
+//               report and the page go to standard error
+//   -q          report only, don't show the page
+//   -s n        micro spaces per character (default 10, 12 for Pica, 8 for Micro Elite)
+//   -v n        micro lines per line (default 16, 12 for Micro Elite)
+//   -p n        printwheel pitch returned for the reset command (default 0x20, 12P)
+//   -w us       time to turn the printwheel one spoke
+//   -k us       time to settle the printwheel and strike
+//   -c us       time to move the carrier one micro space
+//   -C us       time to start and stop the carrier
+//   -l us       time to move the paper one micro line
+//   -L us       time to start and stop the platen
+//------------------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "pbmodel.h"
+
+static void usage(void) {
+    fprintf(stderr,"usage: wwprinter [-a] [-q] [-s n] [-v n] [-p n] [-w us] [-k us] [-c us] [-C us] [-l us] [-L us] [file]\n");
+    exit(1);
+}
+
+//------------------------------------------------------------------------------------------
+// prints the modeled time, speed and travel
+//------------------------------------------------------------------------------------------
+static void report(FILE *f,const pb_stats_t *s) {
+    fprintf(f,"words:            %lu\n",s->words);
+    fprintf(f,"commands:         %lu\n",s->commands);
+    fprintf(f,"characters:       %lu\n",s->glyphs);
+    fprintf(f,"erased:           %lu\n",s->erased);
+    fprintf(f,"time:             %.3f s\n",s->elapsed/1000000.0);
+    if (s->elapsed > 0)
+        fprintf(f,"chars/sec:        %.2f\n",s->glyphs/(s->elapsed/1000000.0));
+    if (s->glyphs)
+        fprintf(f,"words/char:       %.2f\n",(double)s->words/s->glyphs);
+    fprintf(f,"carrier travel:   %lu micro spaces\n",s->carrierTravel);
+    fprintf(f,"printwheel travel:%lu spokes\n",s->wheelTravel);
+    fprintf(f,"paper travel:     %lu micro lines\n",s->paperTravel);
+}
+
+int main(int argc,char *argv[]) {
+    pb_timing_t timing = pb_default_timing;
+    int spaces = 10,lines = 16,pitch = 0x20;
+    int pipe = 0,quiet = 0,opt,source;
+    unsigned int word,reply;
+    double t;
+    char line[4096],*tok[1024],*p;
+    int i,n;
+    FILE *f = stdin,*out = stdout;
+
+    while ((opt = getopt(argc,argv,"aqs:v:p:w:k:c:C:l:L:")) != -1) {
+        switch(opt) {
+            case 'a': pipe = 1; break;
+            case 'q': quiet = 1; break;
+            case 's': spaces = atoi(optarg); break;
+            case 'v': lines = atoi(optarg); break;
+            case 'p': pitch = strtol(optarg,NULL,0); break;
+            case 'w': timing.spoke = atof(optarg); break;
+            case 'k': timing.strike = atof(optarg); break;
+            case 'c': timing.carrierPerMicroSpace = atof(optarg); break;
+            case 'C': timing.carrierStart = atof(optarg); break;
+            case 'l': timing.paperPerMicroLine = atof(optarg); break;
+            case 'L': timing.paperStart = atof(optarg); break;
+            default: usage();
+        }
+    }
+    if ((spaces < 1) || (lines < 1)) usage();
+    if (optind < argc) {
+        if (!(f = fopen(argv[optind],"r"))) {
+            perror(argv[optind]);
+            return 1;
+        }
+    }
+    if (pipe) out = stderr;
+
+    pb_init(&timing,spaces,lines,pitch);
+    while (fgets(line,sizeof(line),f)) {
+        for(n=0,p=strtok(line," \t\r\n"); p && (n < 1024); p=strtok(NULL," \t\r\n"))
+            tok[n++] = p;
+        if ((n == 3) && (strlen(tok[0]) == 1) && (strlen(tok[2]) == 8)) {// a trace line: source, word, time stamp
+            source = atoi(tok[0]);
+            if (source != 2) continue;                      // only the words sent to the Printer Board
+            tok[0] = tok[1];
+            n = 1;
+        }
+        for(i=0; i<n; i++) {
+            word = strtoul(tok[i],&p,16);
+            if (*p) break;                                  // not a hex word, ignore the rest of the line
+            reply = pb_word(word & 0x1FF,&t);
+            if (pipe) {
+                usleep((useconds_t)t);
+                printf("%03X\n",reply);
+                fflush(stdout);
+            }
+        }
+    }
+
+    report(out,pb_stats());
+    if (!quiet) {
+        fprintf(out,"\n");
+        pb_render(out);
+    }
+    return 0;
+}
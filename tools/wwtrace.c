@@ -0,0 +1,285 @@
+//------------------------------------------------------------------------------------------
+// wwtrace - decodes a Wheelwriter bus trace dumped by the <ESC><^Z><d> command
+//
+// For Linux (gcc). Reads the trace dump captured from UART1 (the 'TRACE' line, one
+// 'S WWW TTTTTTTT' line per word and the closing '.') from a file or standard input,
+// prints each command sent on the Function Board and Printer Board buses with its
+// meaning and the time taken for it to be acknowledged, then a summary of acknowledge
+// latency per command, bus utilization and bus words per printed character.
+//
+// usage: wwtrace [-q] [tracefile]
+//        -q  summary only, don't list the commands
+//
+// S is the source of the word:
+//   0 received from the Function Board   (Function Board bus)
+//   1 received from the Printer Board    (Printer Board bus)
+//   2 sent to the Printer Board          (Printer Board bus)
+//   3 sent to the Function Board         (Function Board bus)
+//
+// The commands are decoded with the same grammar as ww_decode_keys() in wheelwriter.c:
+//   0x121,0x003,code,advance       strike printwheel 'code', advance the carrier
+//   0x121,0x005,data               vertical movement, bit 7 set for paper up
+//   0x121,0x006,high,low           horizontal movement, bit 7 of 'high' set for left to right
+//   0x121,0x00E,key                code key combination
+// anything else following 0x121 is listed as it is.
+//------------------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WORDUSEC (11.0*1000000.0/187500.0)          // 11 bits at 187500bps = 58.7 microseconds per word
+#define MAXWORDS 65536
+
+typedef struct {
+    int source;
+    unsigned int word;
+    unsigned long usec;
+} entry_t;
+
+// statistics for one kind of command
+typedef struct {
+    const char *name;
+    unsigned long count;                            // commands
+    unsigned long acked;                            // commands with every word acknowledged
+    double total;                                   // sum of the acknowledge latencies
+    double max;                                     // longest acknowledge latency
+} stats_t;
+
+enum {STRIKE,SPACE,VERTICAL,HORIZONTAL,CODEKEY,OTHER,NKINDS};
+
+static stats_t stats[2][NKINDS] = {
+    {{"strike"},{"space"},{"vertical"},{"horizontal"},{"code key"},{"other"}},
+    {{"strike"},{"space"},{"vertical"},{"horizontal"},{"code key"},{"other"}}
+};
+
+static entry_t trace[MAXWORDS];
+static int count = 0;
+static int quiet = 0;
+
+//------------------------------------------------------------------------------------------
+// reads the trace dump. lines that are not part of a dump are ignored so that a complete
+// UART1 log can be used.
+//------------------------------------------------------------------------------------------
+static void read_trace(FILE *f) {
+    char line[256];
+    int source,inDump = 0;
+    unsigned int word;
+    unsigned long usec;
+
+    while (fgets(line,sizeof(line),f)) {
+        if (!strncmp(line,"TRACE",5)) {
+            inDump = 1;
+            continue;
+        }
+        if (line[0] == '.') {
+            inDump = 0;
+            continue;
+        }
+        if (inDump && (count < MAXWORDS) && (sscanf(line,"%d %x %lx",&source,&word,&usec) == 3)) {
+            trace[count].source = source & 0x03;
+            trace[count].word = word & 0x1FF;
+            trace[count].usec = usec;
+            ++count;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// microseconds from trace entry 'a' to trace entry 'b'. the time stamps are 32 bits and wrap.
+//------------------------------------------------------------------------------------------
+static double elapsed(int a,int b) {
+    return (double)(unsigned long)((trace[b].usec-trace[a].usec) & 0xFFFFFFFFUL);
+}
+
+//------------------------------------------------------------------------------------------
+// returns the index of the acknowledge of the command word at index 'i', -1 if there isn't one.
+// the acknowledge is the next all zero word coming the other way on the same bus.
+//------------------------------------------------------------------------------------------
+static int find_ack(int i) {
+    int j,reply;
+
+    reply = (trace[i].source == 0) ? 3 : 1;         // Function Board words are acknowledged by us, our words by the Printer Board
+    for(j=i+1; j<count; j++) {
+        if (trace[j].source == trace[i].source)     // another command word before the acknowledge
+            return -1;
+        if (trace[j].source == reply)
+            return trace[j].word ? -1 : j;
+    }
+    return -1;
+}
+
+//------------------------------------------------------------------------------------------
+// returns the index of the next command word on the bus of 'source' after index 'i', -1 if none
+//------------------------------------------------------------------------------------------
+static int next_word(int i,int source) {
+    for(++i; i<count; i++)
+        if (trace[i].source == source) return i;
+    return -1;
+}
+
+//------------------------------------------------------------------------------------------
+// decodes the commands from one source (0 = Function Board, 2 = sent to the Printer Board)
+//------------------------------------------------------------------------------------------
+static void decode(int source,unsigned long *glyphs,unsigned long *words) {
+    int i,j,n,ack,kind,acked;
+    int idx[8];
+    unsigned int w[8];
+    double latency,max;
+    char text[80];
+    stats_t *s;
+
+    *glyphs = *words = 0;
+    for(i=next_word(-1,source); i>=0; i=next_word(idx[n-1],source)) {
+        // gather the words of one command, 0x121 followed by an opcode and its data
+        n = 0;
+        idx[n] = i;
+        w[n++] = trace[i].word;
+        if (w[0] == 0x121) {
+            j = next_word(i,source);
+            if (j >= 0) {
+                idx[n] = j;
+                w[n++] = trace[j].word;
+                switch(w[1]) {
+                    case 0x003: j = 2; break;       // printwheel code and advance
+                    case 0x005: j = 1; break;       // one data word
+                    case 0x006: j = 2; break;       // high and low bits of the distance
+                    case 0x00E: j = 1; break;       // key
+                    default:    j = 0;
+                }
+                while (j-- && (n < 8) && (next_word(idx[n-1],source) >= 0)) {
+                    idx[n] = next_word(idx[n-1],source);
+                    w[n] = trace[idx[n]].word;
+                    ++n;
+                }
+            }
+        }
+        *words += n;
+
+        // what is it?
+        kind = OTHER;
+        if ((n == 4) && (w[0] == 0x121) && (w[1] == 0x003)) {
+            kind = w[2] ? STRIKE : SPACE;
+            if (w[2]) ++*glyphs;
+            sprintf(text,"strike 0x%02X, advance %u",w[2],w[3]);
+        }
+        else if ((n == 3) && (w[0] == 0x121) && (w[1] == 0x005)) {
+            kind = VERTICAL;
+            sprintf(text,"paper %s %u micro lines",(w[2] & 0x80) ? "up" : "down",w[2] & 0x1F);
+        }
+        else if ((n == 4) && (w[0] == 0x121) && (w[1] == 0x006)) {
+            kind = HORIZONTAL;
+            sprintf(text,"carrier %s %u micro spaces",(w[2] & 0x80) ? "right" : "left",((w[2] & 0x07)<<8)|w[3]);
+        }
+        else if ((n == 3) && (w[0] == 0x121) && (w[1] == 0x00E)) {
+            kind = CODEKEY;
+            sprintf(text,"code key 0x%02X",w[2] & 0x7F);
+        }
+        else {
+            text[0] = 0;
+            for(j=0; j<n; j++)
+                sprintf(text+strlen(text),"%03X ",w[j]);
+        }
+
+        // how long did it take to be acknowledged?
+        latency = max = 0;
+        acked = 1;
+        for(j=0; j<n; j++) {
+            ack = find_ack(idx[j]);
+            if (ack < 0) {
+                acked = 0;
+                continue;
+            }
+            latency += elapsed(idx[j],ack);
+            if (elapsed(idx[j],ack) > max) max = elapsed(idx[j],ack);
+        }
+
+        s = &stats[source == 2][kind];
+        ++s->count;
+        if (acked) {
+            ++s->acked;
+            s->total += latency;
+            if (latency > s->max) s->max = latency;
+        }
+
+        if (!quiet) {
+            if (acked)
+                printf("%12.3f %s %-36s ack %8.1f us\n",trace[i].usec/1000.0,source ? "MCU->PB" : "FB->MCU",text,latency);
+            else
+                printf("%12.3f %s %-36s not acknowledged\n",trace[i].usec/1000.0,source ? "MCU->PB" : "FB->MCU",text);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------
+// prints the fraction of the time each bus was busy with words
+//------------------------------------------------------------------------------------------
+static void utilization(void) {
+    unsigned long fb = 0,pb = 0;
+    double span;
+    int i;
+
+    for(i=0; i<count; i++) {
+        if ((trace[i].source == 0) || (trace[i].source == 3)) ++fb;
+        else ++pb;
+    }
+    span = elapsed(0,count-1)+WORDUSEC;
+    printf("\ntrace: %d words in %.3f ms\n",count,span/1000.0);
+    printf("Function Board bus: %lu words, %.1f%% busy\n",fb,100.0*fb*WORDUSEC/span);
+    printf("Printer Board bus:  %lu words, %.1f%% busy\n",pb,100.0*pb*WORDUSEC/span);
+}
+
+//------------------------------------------------------------------------------------------
+// prints the acknowledge latency statistics for the commands from one source
+//------------------------------------------------------------------------------------------
+static void summary(const char *title,stats_t *s,unsigned long glyphs,unsigned long words) {
+    int k;
+
+    printf("\n%s\n",title);
+    printf("  %-12s %8s %12s %12s\n","command","count","mean ack us","max ack us");
+    for(k=0; k<NKINDS; k++) {
+        if (!s[k].count) continue;
+        if (s[k].acked)
+            printf("  %-12s %8lu %12.1f %12.1f\n",s[k].name,s[k].count,s[k].total/s[k].acked,s[k].max);
+        else
+            printf("  %-12s %8lu %12s %12s\n",s[k].name,s[k].count,"-","-");
+    }
+    if (glyphs)
+        printf("  %lu words, %lu printed characters, %.2f words per character\n",words,glyphs,(double)words/glyphs);
+    else
+        printf("  %lu words, no printed characters\n",words);
+}
+
+int main(int argc,char *argv[]) {
+    FILE *f = stdin;
+    unsigned long fbGlyphs,fbWords,pbGlyphs,pbWords;
+    int i;
+
+    for(i=1; i<argc; i++) {
+        if (!strcmp(argv[i],"-q"))
+            quiet = 1;
+        else if (argv[i][0] == '-') {
+            fprintf(stderr,"usage: wwtrace [-q] [tracefile]\n");
+            return 1;
+        }
+        else if (!(f = fopen(argv[i],"r"))) {
+            perror(argv[i]);
+            return 1;
+        }
+    }
+
+    read_trace(f);
+    if (!count) {
+        fprintf(stderr,"wwtrace: no trace found\n");
+        return 1;
+    }
+
+    if (!quiet) printf("Function Board to MCU:\n");
+    decode(0,&fbGlyphs,&fbWords);
+    if (!quiet) printf("\nMCU to Printer Board:\n");
+    decode(2,&pbGlyphs,&pbWords);
+    utilization();
+    summary("Function Board to MCU (acknowledged by the MCU):",stats[0],fbGlyphs,fbWords);
+    summary("MCU to Printer Board (acknowledged by the Printer Board):",stats[1],pbGlyphs,pbWords);
+    return 0;
+}